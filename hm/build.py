@@ -115,10 +115,30 @@ def build_project():
             '/LIBPATH:' + lib_path,
             'build\\unwinder.obj', 'build\\unwinder_helpers.obj',
             'build\\test_push_nonvol.obj', 'build\\test_and_unwind.obj',  
-            'kernel32.lib', 'dbghelp.lib',
+            'kernel32.lib', 'dbghelp.lib', 'cabinet.lib',
             '/DEF:src\\unwinder.def'
         ], env=env, check=True)  
         
+        print("Building dump converter...")
+        subprocess.run([
+            'cl', '/Fo:build\\dump_convert.obj', '/Fe:build\\dump_convert.exe',
+            'src\\dump_convert.c',
+            '/I', um_path,
+            '/I', shared_path,
+            '/link', '/LIBPATH:' + lib_path,
+            'kernel32.lib'
+        ], env=env, check=True)
+        
+        print("Building unwind service...")
+        subprocess.run([
+            'cl', '/Fo:build\\unwind_service.obj', '/Fe:build\\unwind_service.exe',
+            'src\\unwind_service.c',
+            '/I', um_path,
+            '/I', shared_path,
+            '/link', '/LIBPATH:' + lib_path,
+            'kernel32.lib', 'ws2_32.lib'
+        ], env=env, check=True)
+        
         print("Build completed successfully!")
         
         print("\nVerifying exports...")
@@ -0,0 +1,74 @@
+#include <windows.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef BOOL (__stdcall *ConvertDumpFunc)(const char*, const char*, DWORD);
+typedef BOOL (__stdcall *ExpandDumpFunc)(const char*, const char*);
+typedef BOOL (__stdcall *GetLastErrorFunc)(DWORD*, char*, size_t, DWORD64*);
+
+static HMODULE load_unwinder(void) {
+    char path[MAX_PATH];
+    DWORD length = GetModuleFileNameA(NULL, path, sizeof(path));
+    char* slash = length ? strrchr(path, '\\') : NULL;
+    if (!slash || (size_t)(slash - path) + sizeof("\\unwinder.dll") > sizeof(path)) return NULL;
+    strcpy_s(slash, sizeof(path) - (slash - path), "\\unwinder.dll");
+
+    HMODULE dll = LoadLibraryA(path);
+    if (!dll) printf("Failed to load %s: %lu\n", path, GetLastError());
+    return dll;
+}
+
+static void print_usage(const char* argv0) {
+    printf("Usage: %s --convert in.dmp out.sdmp [--block-size bytes]\n", argv0);
+    printf("       %s --expand in.sdmp out.dmp\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4 || (strcmp(argv[1], "--convert") != 0 && strcmp(argv[1], "--expand") != 0)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    BOOL convert = strcmp(argv[1], "--convert") == 0;
+    DWORD blockSize = 0;
+    if (argc == 6 && convert && strcmp(argv[4], "--block-size") == 0) {
+        blockSize = strtoul(argv[5], NULL, 10);
+    } else if (argc != 4) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    HMODULE dll = load_unwinder();
+    if (!dll) return 1;
+
+    ConvertDumpFunc convert_dump = (ConvertDumpFunc)GetProcAddress(dll, "convert_dump_to_seekable");
+    ExpandDumpFunc expand_dump = (ExpandDumpFunc)GetProcAddress(dll, "expand_seekable_dump");
+    GetLastErrorFunc get_last_error = (GetLastErrorFunc)GetProcAddress(dll, "get_last_error");
+    if (!convert_dump || !expand_dump || !get_last_error) {
+        printf("unwinder.dll is missing dump conversion exports\n");
+        FreeLibrary(dll);
+        return 1;
+    }
+
+    LARGE_INTEGER start, end, freq;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+    BOOL ok = convert ? convert_dump(argv[2], argv[3], blockSize) : expand_dump(argv[2], argv[3]);
+    QueryPerformanceCounter(&end);
+
+    if (!ok) {
+        DWORD code = 0;
+        char message[256] = {0};
+        get_last_error(&code, message, sizeof(message), NULL);
+        printf("%s failed: error %lu: %s\n", convert ? "Conversion" : "Expansion", code, message);
+        FreeLibrary(dll);
+        return 1;
+    }
+
+    printf("%s %s -> %s in %.1f ms\n", convert ? "Converted" : "Expanded", argv[2], argv[3],
+           (double)(end.QuadPart - start.QuadPart) * 1000.0 / (double)freq.QuadPart);
+    FreeLibrary(dll);
+    return 0;
+}
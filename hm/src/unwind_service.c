@@ -0,0 +1,695 @@
+#include <winsock2.h>
+#include <afunix.h>
+#include <windows.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UWS_REQUEST_MAGIC 0x51535755   /* "UWSQ" */
+#define UWS_RESPONSE_MAGIC 0x52535755  /* "UWSR" */
+#define UWS_VERSION 3
+#define UWS_MAX_PAYLOAD (64 * 1024 * 1024)
+#define UWS_MAX_FRAMES 256
+#define UWS_MAX_MODULES 512
+#define UWS_BATCH_SIZE 4
+#define UWS_BATCH_SCAN 64
+#define UWS_DEFAULT_SOCKET "unwinder.sock"
+#define UWS_DEFAULT_CACHE_MB 256
+#define UWS_DEFAULT_QUEUE_MB 256
+
+enum {
+    UWS_REQ_DUMP = 1,
+    UWS_REQ_STACK = 2,
+    UWS_REQ_STATS = 3
+};
+
+enum {
+    UWS_OK = 0,
+    UWS_ERR_BAD_REQUEST = 1,
+    UWS_ERR_OPEN = 2,
+    UWS_ERR_WALK = 3
+};
+
+/*
+ * Wire format, little endian. Every message is a fixed header followed by
+ * payloadSize bytes:
+ *   DUMP  request:  UWS_DUMP_REQUEST, then the dump path (no terminator)
+ *   STACK request:  UWS_STACK_REQUEST, moduleCount x (UWS_MODULE_ENTRY, path),
+ *                   then stackSize bytes of stack starting at stackBase
+ *                   Module entries carry SizeOfImage, TimeDateStamp and
+ *                   CheckSum; an image on disk that does not match is not used.
+ *   STATS request:  empty
+ * Responses carry frameCount return addresses, or UWS_STATS_RESPONSE.
+ */
+#pragma pack(push, 1)
+typedef struct _UWS_REQUEST_HEADER {
+    DWORD magic;
+    WORD version;
+    WORD type;
+    DWORD requestId;
+    DWORD payloadSize;
+} UWS_REQUEST_HEADER;
+
+typedef struct _UWS_DUMP_REQUEST {
+    DWORD threadIndex;
+    WORD maxFrames;
+    WORD pathLength;
+} UWS_DUMP_REQUEST;
+
+typedef struct _UWS_STACK_REQUEST {
+    DWORD64 registers[17];  /* Rax..R15 in CONTEXT order, then Rip */
+    DWORD64 stackBase;
+    DWORD stackSize;
+    WORD maxFrames;
+    WORD moduleCount;
+} UWS_STACK_REQUEST;
+
+typedef struct _UWS_MODULE_ENTRY {
+    DWORD64 base;
+    DWORD size;
+    DWORD timeDateStamp;
+    DWORD checkSum;
+    WORD pathLength;
+} UWS_MODULE_ENTRY;
+
+typedef struct _UWS_RESPONSE_HEADER {
+    DWORD magic;
+    WORD status;
+    WORD frameCount;
+    DWORD requestId;
+    DWORD payloadSize;
+} UWS_RESPONSE_HEADER;
+
+typedef struct _UWS_STATS_RESPONSE {
+    DWORD64 requests;
+    DWORD64 cacheHits;
+    DWORD64 cacheMisses;
+    DWORD64 evictions;
+    DWORD64 rejected;
+    DWORD64 bytesUsed;
+    DWORD64 budget;
+    DWORD entries;
+} UWS_STATS_RESPONSE;
+#pragma pack(pop)
+
+typedef struct _MODULE_CACHE_STATS {
+    DWORD64 hits;
+    DWORD64 misses;
+    DWORD64 evictions;
+    DWORD64 rejected;
+    SIZE_T bytesUsed;
+    SIZE_T budget;
+    DWORD entries;
+} MODULE_CACHE_STATS;
+
+typedef struct _SNAPSHOT_MODULE {
+    DWORD64 base;
+    DWORD size;
+    DWORD timeDateStamp;
+    DWORD checkSum;
+    const char* path;
+} SNAPSHOT_MODULE;
+
+typedef void* (__stdcall *OpenDumpFunc)(const char*, DWORD);
+typedef void (__stdcall *CloseDumpFunc)(void*);
+typedef BOOL (__stdcall *WalkDumpThreadFunc)(void*, DWORD, DWORD64*, DWORD, DWORD*);
+typedef void* (__stdcall *OpenStackSnapshotFunc)(const CONTEXT*, DWORD64, const BYTE*, DWORD,
+                                                 const SNAPSHOT_MODULE*, DWORD);
+typedef void* (__stdcall *CreateModuleCacheFunc)(SIZE_T);
+typedef void (__stdcall *DestroyModuleCacheFunc)(void*);
+typedef BOOL (__stdcall *GetModuleCacheStatsFunc)(void*, MODULE_CACHE_STATS*);
+typedef BOOL (__stdcall *AttachModuleCacheFunc)(void*, void*);
+typedef void (__stdcall *SetDebugLevelFunc)(DWORD);
+
+typedef struct _UWS_CORE {
+    HMODULE dll;
+    OpenDumpFunc open_dump;
+    CloseDumpFunc close_dump;
+    WalkDumpThreadFunc walk_dump_thread;
+    OpenStackSnapshotFunc open_stack_snapshot;
+    CreateModuleCacheFunc create_module_cache;
+    DestroyModuleCacheFunc destroy_module_cache;
+    GetModuleCacheStatsFunc get_module_cache_stats;
+    AttachModuleCacheFunc attach_module_cache;
+    SetDebugLevelFunc set_debug_level;
+} UWS_CORE;
+
+typedef struct _UWS_CONNECTION {
+    SOCKET socket;
+    volatile LONG refs;
+    SRWLOCK sendLock;
+} UWS_CONNECTION;
+
+typedef struct _UWS_JOB {
+    UWS_CONNECTION* conn;
+    UWS_REQUEST_HEADER header;
+    BYTE* payload;
+    char path[MAX_PATH];
+    struct _UWS_JOB* next;
+} UWS_JOB;
+
+typedef struct _UWS_SERVICE {
+    UWS_CORE core;
+    void* cache;
+    SOCKET listener;
+    SRWLOCK queueLock;
+    CONDITION_VARIABLE queueReady;
+    CONDITION_VARIABLE queueSpace;
+    UWS_JOB* queueHead;
+    UWS_JOB* queueTail;
+    SIZE_T queuedBytes;
+    SIZE_T queueLimit;
+    HANDLE recordFile;
+    SRWLOCK recordLock;
+    volatile LONG64 requests;
+    volatile LONG stopping;
+} UWS_SERVICE;
+
+static UWS_SERVICE g_service = {0};
+
+static BOOL load_core(UWS_CORE* core) {
+    char path[MAX_PATH];
+    DWORD length = GetModuleFileNameA(NULL, path, sizeof(path));
+    char* slash = length ? strrchr(path, '\\') : NULL;
+    if (!slash || (size_t)(slash - path) + sizeof("\\unwinder.dll") > sizeof(path)) return FALSE;
+    strcpy_s(slash, sizeof(path) - (slash - path), "\\unwinder.dll");
+
+    core->dll = LoadLibraryA(path);
+    if (!core->dll) {
+        printf("Failed to load %s: %lu\n", path, GetLastError());
+        return FALSE;
+    }
+
+    core->open_dump = (OpenDumpFunc)GetProcAddress(core->dll, "open_dump");
+    core->close_dump = (CloseDumpFunc)GetProcAddress(core->dll, "close_dump");
+    core->walk_dump_thread = (WalkDumpThreadFunc)GetProcAddress(core->dll, "walk_dump_thread");
+    core->open_stack_snapshot = (OpenStackSnapshotFunc)GetProcAddress(core->dll, "open_stack_snapshot");
+    core->create_module_cache = (CreateModuleCacheFunc)GetProcAddress(core->dll, "create_module_cache");
+    core->destroy_module_cache = (DestroyModuleCacheFunc)GetProcAddress(core->dll, "destroy_module_cache");
+    core->get_module_cache_stats = (GetModuleCacheStatsFunc)GetProcAddress(core->dll, "get_module_cache_stats");
+    core->attach_module_cache = (AttachModuleCacheFunc)GetProcAddress(core->dll, "attach_module_cache");
+    core->set_debug_level = (SetDebugLevelFunc)GetProcAddress(core->dll, "set_debug_level");
+
+    if (!core->open_dump || !core->close_dump || !core->walk_dump_thread ||
+        !core->open_stack_snapshot || !core->create_module_cache || !core->destroy_module_cache ||
+        !core->get_module_cache_stats || !core->attach_module_cache || !core->set_debug_level) {
+        printf("unwinder.dll is missing service exports\n");
+        FreeLibrary(core->dll);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static BOOL recv_all(SOCKET s, void* buffer, DWORD size) {
+    char* p = (char*)buffer;
+    while (size > 0) {
+        int n = recv(s, p, size > INT_MAX ? INT_MAX : (int)size, 0);
+        if (n <= 0) return FALSE;
+        p += n;
+        size -= n;
+    }
+    return TRUE;
+}
+
+static BOOL send_all(SOCKET s, const void* buffer, DWORD size) {
+    const char* p = (const char*)buffer;
+    while (size > 0) {
+        int n = send(s, p, size > INT_MAX ? INT_MAX : (int)size, 0);
+        if (n <= 0) return FALSE;
+        p += n;
+        size -= n;
+    }
+    return TRUE;
+}
+
+static void release_connection(UWS_CONNECTION* conn) {
+    if (InterlockedDecrement(&conn->refs) == 0) {
+        closesocket(conn->socket);
+        free(conn);
+    }
+}
+
+static void send_response(UWS_JOB* job, WORD status, const void* payload, DWORD payloadSize, WORD frameCount) {
+    UWS_RESPONSE_HEADER header = {0};
+    header.magic = UWS_RESPONSE_MAGIC;
+    header.status = status;
+    header.frameCount = frameCount;
+    header.requestId = job->header.requestId;
+    header.payloadSize = payloadSize;
+
+    /* Workers answer out of order, so a whole response goes out under the lock. */
+    AcquireSRWLockExclusive(&job->conn->sendLock);
+    if (send_all(job->conn->socket, &header, sizeof(header)) && payloadSize) {
+        send_all(job->conn->socket, payload, payloadSize);
+    }
+    ReleaseSRWLockExclusive(&job->conn->sendLock);
+}
+
+static void send_frames(UWS_JOB* job, WORD status, const DWORD64* frames, DWORD frameCount) {
+    send_response(job, status, frames, frameCount * sizeof(DWORD64), (WORD)frameCount);
+}
+
+static DWORD clamp_frames(WORD requested) {
+    return requested == 0 || requested > UWS_MAX_FRAMES ? UWS_MAX_FRAMES : requested;
+}
+
+static void walk_job(UWS_JOB* job, void* reader, DWORD threadIndex, WORD maxFrames) {
+    DWORD64 frames[UWS_MAX_FRAMES];
+    DWORD frameCount = 0;
+
+    if (!g_service.core.walk_dump_thread(reader, threadIndex, frames, clamp_frames(maxFrames), &frameCount)) {
+        send_frames(job, UWS_ERR_WALK, NULL, 0);
+        return;
+    }
+    send_frames(job, UWS_OK, frames, frameCount);
+}
+
+static void handle_stack_job(UWS_JOB* job) {
+    const BYTE* p = job->payload;
+    const BYTE* end = job->payload + job->header.payloadSize;
+    if ((size_t)(end - p) < sizeof(UWS_STACK_REQUEST)) {
+        send_frames(job, UWS_ERR_BAD_REQUEST, NULL, 0);
+        return;
+    }
+
+    UWS_STACK_REQUEST request;
+    memcpy(&request, p, sizeof(request));
+    p += sizeof(request);
+
+    if (request.moduleCount > UWS_MAX_MODULES) {
+        send_frames(job, UWS_ERR_BAD_REQUEST, NULL, 0);
+        return;
+    }
+
+    SNAPSHOT_MODULE* modules = (SNAPSHOT_MODULE*)calloc(request.moduleCount + 1, sizeof(SNAPSHOT_MODULE));
+    char* paths = (char*)calloc(request.moduleCount + 1, MAX_PATH);
+    BOOL ok = modules && paths;
+
+    for (WORD i = 0; ok && i < request.moduleCount; i++) {
+        UWS_MODULE_ENTRY entry;
+        if ((size_t)(end - p) < sizeof(entry)) {
+            ok = FALSE;
+            break;
+        }
+        memcpy(&entry, p, sizeof(entry));
+        p += sizeof(entry);
+
+        if (entry.pathLength >= MAX_PATH || (size_t)(end - p) < entry.pathLength) {
+            ok = FALSE;
+            break;
+        }
+        memcpy(paths + (size_t)i * MAX_PATH, p, entry.pathLength);
+        p += entry.pathLength;
+
+        modules[i].base = entry.base;
+        modules[i].size = entry.size;
+        modules[i].timeDateStamp = entry.timeDateStamp;
+        modules[i].checkSum = entry.checkSum;
+        modules[i].path = paths + (size_t)i * MAX_PATH;
+    }
+
+    if (!ok || (size_t)(end - p) != request.stackSize) {
+        send_frames(job, UWS_ERR_BAD_REQUEST, NULL, 0);
+        free(modules);
+        free(paths);
+        return;
+    }
+
+    CONTEXT ctx = {0};
+    ctx.ContextFlags = CONTEXT_FULL;
+    memcpy(&ctx.Rax, request.registers, 16 * sizeof(DWORD64));
+    ctx.Rip = request.registers[16];
+
+    void* reader = g_service.core.open_stack_snapshot(&ctx, request.stackBase, p, request.stackSize,
+                                                      modules, request.moduleCount);
+    if (!reader) {
+        send_frames(job, UWS_ERR_OPEN, NULL, 0);
+    } else {
+        g_service.core.attach_module_cache(reader, g_service.cache);
+        walk_job(job, reader, 0, request.maxFrames);
+        g_service.core.close_dump(reader);
+    }
+
+    free(modules);
+    free(paths);
+}
+
+static void handle_stats_job(UWS_JOB* job) {
+    MODULE_CACHE_STATS cacheStats = {0};
+    g_service.core.get_module_cache_stats(g_service.cache, &cacheStats);
+
+    UWS_STATS_RESPONSE stats = {0};
+    stats.requests = (DWORD64)g_service.requests;
+    stats.cacheHits = cacheStats.hits;
+    stats.cacheMisses = cacheStats.misses;
+    stats.evictions = cacheStats.evictions;
+    stats.rejected = cacheStats.rejected;
+    stats.bytesUsed = cacheStats.bytesUsed;
+    stats.budget = cacheStats.budget;
+    stats.entries = cacheStats.entries;
+    send_response(job, UWS_OK, &stats, sizeof(stats), 0);
+}
+
+static SIZE_T job_cost(DWORD payloadSize) {
+    return sizeof(UWS_JOB) + payloadSize;
+}
+
+/*
+ * Connection threads reserve a request's memory before reading its
+ * payload, so clients that pipeline faster than the workers drain stop
+ * being read instead of growing the queue. A request bigger than the
+ * whole limit is still let through once nothing else is queued.
+ */
+static BOOL reserve_queue_space(DWORD payloadSize) {
+    SIZE_T cost = job_cost(payloadSize);
+
+    AcquireSRWLockExclusive(&g_service.queueLock);
+    while (!g_service.stopping && g_service.queuedBytes > 0 &&
+           g_service.queuedBytes + cost > g_service.queueLimit) {
+        SleepConditionVariableSRW(&g_service.queueSpace, &g_service.queueLock, INFINITE, 0);
+    }
+    BOOL reserved = !g_service.stopping;
+    if (reserved) g_service.queuedBytes += cost;
+    ReleaseSRWLockExclusive(&g_service.queueLock);
+    return reserved;
+}
+
+static void release_queue_space(DWORD payloadSize) {
+    AcquireSRWLockExclusive(&g_service.queueLock);
+    g_service.queuedBytes -= job_cost(payloadSize);
+    ReleaseSRWLockExclusive(&g_service.queueLock);
+    WakeAllConditionVariable(&g_service.queueSpace);
+}
+
+/*
+ * The batch is one job, plus a few queued DUMP jobs for the same path so the
+ * dump is opened and its streams parsed once for all of them.
+ */
+static void process_batch(UWS_JOB** jobs, DWORD count) {
+    UWS_JOB* job = jobs[0];
+
+    if (job->header.type == UWS_REQ_STACK) {
+        handle_stack_job(job);
+    } else if (job->header.type == UWS_REQ_STATS) {
+        handle_stats_job(job);
+    } else if (job->header.type != UWS_REQ_DUMP || !job->path[0]) {
+        send_frames(job, UWS_ERR_BAD_REQUEST, NULL, 0);
+    } else {
+        void* reader = g_service.core.open_dump(job->path, 0);
+        if (reader) g_service.core.attach_module_cache(reader, g_service.cache);
+
+        for (DWORD i = 0; i < count; i++) {
+            if (!reader) {
+                send_frames(jobs[i], UWS_ERR_OPEN, NULL, 0);
+                continue;
+            }
+
+            /* A non-empty path means parse_dump_path validated the payload. */
+            UWS_DUMP_REQUEST request;
+            memcpy(&request, jobs[i]->payload, sizeof(request));
+            walk_job(jobs[i], reader, request.threadIndex, request.maxFrames);
+        }
+
+        if (reader) g_service.core.close_dump(reader);
+    }
+
+    for (DWORD i = 0; i < count; i++) {
+        release_connection(jobs[i]->conn);
+        release_queue_space(jobs[i]->header.payloadSize);
+        free(jobs[i]->payload);
+        free(jobs[i]);
+    }
+}
+
+/*
+ * Takes the head job and unlinks same-path DUMP jobs from the next
+ * UWS_BATCH_SCAN queued ones; the queue lock is held. Batches stay small so
+ * a burst of requests for one dump is spread over the workers, and the
+ * scan is bounded so dequeueing stays cheap however long the queue gets.
+ */
+static DWORD dequeue_batch(UWS_JOB** batch) {
+    UWS_JOB* head = g_service.queueHead;
+    DWORD count = 0;
+
+    batch[count++] = head;
+    g_service.queueHead = head->next;
+    if (!g_service.queueHead) g_service.queueTail = NULL;
+
+    if (head->header.type == UWS_REQ_DUMP && head->path[0]) {
+        UWS_JOB* previous = NULL;
+        UWS_JOB** link = &g_service.queueHead;
+        for (DWORD scanned = 0; *link && count < UWS_BATCH_SIZE && scanned < UWS_BATCH_SCAN; scanned++) {
+            UWS_JOB* job = *link;
+            if (job->header.type == UWS_REQ_DUMP && _stricmp(job->path, head->path) == 0) {
+                *link = job->next;
+                if (g_service.queueTail == job) g_service.queueTail = previous;
+                batch[count++] = job;
+            } else {
+                previous = job;
+                link = &job->next;
+            }
+        }
+    }
+    return count;
+}
+
+static DWORD WINAPI worker_main(LPVOID param) {
+    UWS_JOB* batch[UWS_BATCH_SIZE];
+
+    for (;;) {
+        AcquireSRWLockExclusive(&g_service.queueLock);
+        while (!g_service.queueHead && !g_service.stopping) {
+            SleepConditionVariableSRW(&g_service.queueReady, &g_service.queueLock, INFINITE, 0);
+        }
+        if (!g_service.queueHead) {
+            ReleaseSRWLockExclusive(&g_service.queueLock);
+            return 0;
+        }
+
+        DWORD count = dequeue_batch(batch);
+        BOOL more = g_service.queueHead != NULL;
+        ReleaseSRWLockExclusive(&g_service.queueLock);
+
+        /* Hand what is left to another worker instead of leaving it behind this batch. */
+        if (more) WakeConditionVariable(&g_service.queueReady);
+        process_batch(batch, count);
+    }
+}
+
+static void enqueue_job(UWS_JOB* job) {
+    AcquireSRWLockExclusive(&g_service.queueLock);
+    if (g_service.queueTail) g_service.queueTail->next = job;
+    else g_service.queueHead = job;
+    g_service.queueTail = job;
+    ReleaseSRWLockExclusive(&g_service.queueLock);
+    WakeConditionVariable(&g_service.queueReady);
+}
+
+static void record_request(const UWS_REQUEST_HEADER* header, const BYTE* payload) {
+    DWORD written = 0;
+    AcquireSRWLockExclusive(&g_service.recordLock);
+    WriteFile(g_service.recordFile, header, sizeof(*header), &written, NULL);
+    if (header->payloadSize) WriteFile(g_service.recordFile, payload, header->payloadSize, &written, NULL);
+    ReleaseSRWLockExclusive(&g_service.recordLock);
+}
+
+static BOOL parse_dump_path(UWS_JOB* job) {
+    UWS_DUMP_REQUEST request;
+    if (job->header.payloadSize < sizeof(request)) return FALSE;
+
+    memcpy(&request, job->payload, sizeof(request));
+    if (request.pathLength == 0 || request.pathLength >= MAX_PATH ||
+        job->header.payloadSize != sizeof(request) + request.pathLength) {
+        return FALSE;
+    }
+    memcpy(job->path, job->payload + sizeof(request), request.pathLength);
+    job->path[request.pathLength] = '\0';
+    return TRUE;
+}
+
+static DWORD WINAPI connection_main(LPVOID param) {
+    UWS_CONNECTION* conn = (UWS_CONNECTION*)param;
+
+    for (;;) {
+        UWS_REQUEST_HEADER header;
+        if (!recv_all(conn->socket, &header, sizeof(header))) break;
+        if (header.magic != UWS_REQUEST_MAGIC || header.version != UWS_VERSION ||
+            header.payloadSize > UWS_MAX_PAYLOAD) {
+            printf("Dropping connection: malformed request header\n");
+            break;
+        }
+
+        if (!reserve_queue_space(header.payloadSize)) break;
+
+        UWS_JOB* job = (UWS_JOB*)calloc(1, sizeof(UWS_JOB));
+        BYTE* payload = (BYTE*)malloc(header.payloadSize ? header.payloadSize : 1);
+        if (!job || !payload || !recv_all(conn->socket, payload, header.payloadSize)) {
+            release_queue_space(header.payloadSize);
+            free(job);
+            free(payload);
+            break;
+        }
+
+        job->conn = conn;
+        job->header = header;
+        job->payload = payload;
+        if (header.type == UWS_REQ_DUMP) parse_dump_path(job);
+
+        if (g_service.recordFile != INVALID_HANDLE_VALUE && header.type != UWS_REQ_STATS) {
+            record_request(&header, payload);
+        }
+
+        InterlockedIncrement64(&g_service.requests);
+        InterlockedIncrement(&conn->refs);
+        enqueue_job(job);
+    }
+
+    release_connection(conn);
+    return 0;
+}
+
+static BOOL WINAPI console_handler(DWORD ctrlType) {
+    if (ctrlType != CTRL_C_EVENT && ctrlType != CTRL_BREAK_EVENT) return FALSE;
+
+    InterlockedExchange(&g_service.stopping, 1);
+    closesocket(g_service.listener);
+    WakeAllConditionVariable(&g_service.queueReady);
+    WakeAllConditionVariable(&g_service.queueSpace);
+    return TRUE;
+}
+
+static void print_usage(const char* argv0) {
+    printf("Usage: %s [--socket path] [--workers n] [--cache-mb n] [--queue-mb n] [--record file]\n", argv0);
+    printf("       [--debug-level n]  0 = none (default), 1 = errors, 2 = warnings, 3 = info\n");
+}
+
+int main(int argc, char** argv) {
+    const char* socketPath = UWS_DEFAULT_SOCKET;
+    const char* recordPath = NULL;
+    DWORD workers = 0;
+    DWORD cacheMb = UWS_DEFAULT_CACHE_MB;
+    DWORD queueMb = UWS_DEFAULT_QUEUE_MB;
+    DWORD debugLevel = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--socket") == 0) {
+            socketPath = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--workers") == 0) {
+            workers = strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "--cache-mb") == 0) {
+            cacheMb = strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "--queue-mb") == 0) {
+            queueMb = strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "--record") == 0) {
+            recordPath = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--debug-level") == 0) {
+            debugLevel = strtoul(argv[++i], NULL, 10);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (workers == 0) {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        workers = info.dwNumberOfProcessors;
+    }
+
+    struct sockaddr_un addr = {0};
+    if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+        printf("Socket path too long: %s\n", socketPath);
+        return 1;
+    }
+
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        printf("WSAStartup failed\n");
+        return 1;
+    }
+
+    if (!load_core(&g_service.core)) return 1;
+
+    /* The DLL defaults to info-level logging, which would write to stderr on every request. */
+    g_service.core.set_debug_level(debugLevel);
+
+    g_service.cache = g_service.core.create_module_cache((SIZE_T)cacheMb * 1024 * 1024);
+    if (!g_service.cache) {
+        printf("Failed to create module cache\n");
+        return 1;
+    }
+
+    InitializeSRWLock(&g_service.queueLock);
+    InitializeSRWLock(&g_service.recordLock);
+    InitializeConditionVariable(&g_service.queueReady);
+    InitializeConditionVariable(&g_service.queueSpace);
+    g_service.queueLimit = (SIZE_T)queueMb * 1024 * 1024;
+
+    g_service.recordFile = INVALID_HANDLE_VALUE;
+    if (recordPath) {
+        g_service.recordFile = CreateFileA(recordPath, GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                                           CREATE_ALWAYS, 0, NULL);
+        if (g_service.recordFile == INVALID_HANDLE_VALUE) {
+            printf("Failed to create record file %s: %lu\n", recordPath, GetLastError());
+            return 1;
+        }
+    }
+
+    g_service.listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    addr.sun_family = AF_UNIX;
+    strcpy_s(addr.sun_path, sizeof(addr.sun_path), socketPath);
+    DeleteFileA(socketPath);
+
+    if (g_service.listener == INVALID_SOCKET ||
+        bind(g_service.listener, (struct sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR ||
+        listen(g_service.listener, SOMAXCONN) == SOCKET_ERROR) {
+        printf("Failed to listen on %s: %d\n", socketPath, WSAGetLastError());
+        return 1;
+    }
+
+    HANDLE* threads = (HANDLE*)calloc(workers, sizeof(HANDLE));
+    if (!threads) return 1;
+    for (DWORD i = 0; i < workers; i++) {
+        threads[i] = CreateThread(NULL, 0, worker_main, NULL, 0, NULL);
+    }
+
+    SetConsoleCtrlHandler(console_handler, TRUE);
+    printf("Unwind service listening on %s (%lu workers, %lu MB module cache)\n",
+           socketPath, workers, cacheMb);
+
+    while (!g_service.stopping) {
+        SOCKET client = accept(g_service.listener, NULL, NULL);
+        if (client == INVALID_SOCKET) continue;
+
+        UWS_CONNECTION* conn = (UWS_CONNECTION*)calloc(1, sizeof(UWS_CONNECTION));
+        if (!conn) {
+            closesocket(client);
+            continue;
+        }
+        conn->socket = client;
+        conn->refs = 1;
+        InitializeSRWLock(&conn->sendLock);
+
+        HANDLE thread = CreateThread(NULL, 0, connection_main, conn, 0, NULL);
+        if (thread) {
+            CloseHandle(thread);
+        } else {
+            release_connection(conn);
+        }
+    }
+
+    WaitForMultipleObjects(workers < MAXIMUM_WAIT_OBJECTS ? workers : MAXIMUM_WAIT_OBJECTS,
+                           threads, TRUE, 5000);
+
+    MODULE_CACHE_STATS stats = {0};
+    g_service.core.get_module_cache_stats(g_service.cache, &stats);
+    printf("Served %lld requests; cache hits=%llu misses=%llu evictions=%llu used=%llu/%llu bytes\n",
+           g_service.requests, stats.hits, stats.misses, stats.evictions,
+           (DWORD64)stats.bytesUsed, (DWORD64)stats.budget);
+
+    if (g_service.recordFile != INVALID_HANDLE_VALUE) CloseHandle(g_service.recordFile);
+    DeleteFileA(socketPath);
+    WSACleanup();
+    return 0;
+}
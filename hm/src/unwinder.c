@@ -3,6 +3,9 @@
 #include <stdint.h>
 #include <winnt.h>  
 #include <stdarg.h>
+#include <stdlib.h>
+#include <dbghelp.h>
+#include <compressapi.h>
 
 #define UNWINDER_API __declspec(dllexport)
 
@@ -27,7 +30,8 @@ typedef struct _UNWINDER_ERROR {
 } UNWINDER_ERROR;
 
 static UNWINDER_DEBUG_CONFIG g_debugConfig = {0};
-static UNWINDER_ERROR g_lastError = {0};
+/* Per thread so concurrent callers (e.g. service workers) see their own failure. */
+static __declspec(thread) UNWINDER_ERROR g_lastError = {0};
 
 typedef union _UNWIND_CODE {
     struct {
@@ -539,6 +543,10 @@ static void set_error(DWORD code, const char* message, DWORD64 address) {
                 code, message, (PVOID)address);
 }
 
+UNWINDER_API void set_debug_level(UNWINDER_DEBUG_LEVEL level) {
+    g_debugConfig.level = level;
+}
+
 UNWINDER_API BOOL get_last_error(DWORD* code, char* message, size_t messageSize, DWORD64* address) {
     if (!code || !message || messageSize == 0) return FALSE;
     
@@ -548,3 +556,1512 @@ UNWINDER_API BOOL get_last_error(DWORD* code, char* message, size_t messageSize,
     
     return TRUE;
 }
+
+
+#define SEEKDUMP_SIGNATURE 0x504D4453  /* "SDMP" */
+#define SEEKDUMP_VERSION 1
+#define SEEKDUMP_ALGORITHM (COMPRESS_ALGORITHM_XPRESS_HUFF | COMPRESS_RAW)
+#define SEEKDUMP_DEFAULT_BLOCK_SIZE (64 * 1024)
+#define SEEKDUMP_MAX_BLOCK_SIZE (16 * 1024 * 1024)
+#define SEEKDUMP_DEFAULT_CACHE_BLOCKS 64
+#define SEEKDUMP_BLOCK_STORED 0x1
+#define DUMP_CACHE_EMPTY MAXDWORD
+
+/*
+ * Seekable dump container: a header, independently compressed blocks of
+ * the original .dmp, then an index of (offset, size) per block. Readers
+ * only decompress the blocks they touch.
+ */
+typedef struct _SEEKDUMP_HEADER {
+    DWORD Signature;
+    DWORD Version;
+    DWORD Algorithm;
+    DWORD BlockSize;
+    DWORD64 UncompressedSize;
+    DWORD64 IndexOffset;
+    DWORD BlockCount;
+    DWORD Reserved;
+} SEEKDUMP_HEADER;
+
+typedef struct _SEEKDUMP_INDEX_ENTRY {
+    DWORD64 Offset;
+    DWORD CompressedSize;
+    DWORD Flags;
+} SEEKDUMP_INDEX_ENTRY;
+
+typedef struct _DUMP_CACHE_SLOT {
+    DWORD block;
+    DWORD64 lastUse;
+    BYTE* data;
+} DUMP_CACHE_SLOT;
+
+typedef struct _DUMP_MEMORY_RANGE {
+    DWORD64 start;
+    DWORD64 size;
+    DWORD64 rva;
+} DUMP_MEMORY_RANGE;
+
+typedef struct _DUMP_MODULE {
+    DWORD64 base;
+    DWORD size;
+    DWORD pdataRva;
+    DWORD pdataSize;
+    BOOL pdataResolved;
+    DWORD timeDateStamp;
+    DWORD checkSum;
+    DWORD64 identity;
+    HMODULE imageHandle;
+    BYTE* image;
+    char* path;
+} DUMP_MODULE;
+
+#define MODULE_CACHE_BUCKETS 4096
+#define MODULE_CACHE_PAGE_SIZE 0x1000
+#define MODULE_CACHE_FUNCTIONS 1
+#define MODULE_CACHE_PAGE 2
+#define MODULE_NAME_HASH_BASIS 0xCBF29CE484222325ULL
+#define MODULE_NAME_HASH_PRIME 0x100000001B3ULL
+#define MODULE_NAME_MAX_CHARS 1024
+
+/*
+ * Module cache entries are keyed by module identity, a hash of the file
+ * name, TimeDateStamp, SizeOfImage and CheckSum, so every dump or snapshot
+ * that loaded the same build of a module shares its function table and
+ * image pages. Identity 0 means the module is never cached.
+ */
+typedef struct _MODULE_CACHE_ENTRY {
+    DWORD64 module;
+    DWORD64 key;
+    SIZE_T size;
+    BYTE* data;
+    struct _MODULE_CACHE_ENTRY* hashNext;
+    struct _MODULE_CACHE_ENTRY* lruPrev;
+    struct _MODULE_CACHE_ENTRY* lruNext;
+} MODULE_CACHE_ENTRY;
+
+typedef struct _MODULE_CACHE_STATS {
+    DWORD64 hits;
+    DWORD64 misses;
+    DWORD64 evictions;
+    DWORD64 rejected;
+    SIZE_T bytesUsed;
+    SIZE_T budget;
+    DWORD entries;
+} MODULE_CACHE_STATS;
+
+/* Shared between threads; every operation takes the lock. */
+typedef struct _MODULE_CACHE {
+    SRWLOCK lock;
+    MODULE_CACHE_ENTRY* buckets[MODULE_CACHE_BUCKETS];
+    MODULE_CACHE_ENTRY* lruHead;
+    MODULE_CACHE_ENTRY* lruTail;
+    MODULE_CACHE_STATS stats;
+} MODULE_CACHE;
+
+typedef struct _SNAPSHOT_MODULE {
+    DWORD64 base;
+    DWORD size;
+    DWORD timeDateStamp;
+    DWORD checkSum;
+    const char* path;
+} SNAPSHOT_MODULE;
+
+typedef struct _DUMP_READER_STATS {
+    DWORD64 dumpSize;
+    DWORD64 bytesRead;
+    DWORD64 bytesDecompressed;
+    DWORD blocksDecompressed;
+    DWORD cacheHits;
+    DWORD cacheMisses;
+} DUMP_READER_STATS;
+
+/* A reader is not thread safe; open one per thread. */
+typedef struct _DUMP_READER {
+    HANDLE file;
+    BOOL seekable;
+    SEEKDUMP_HEADER header;
+    SEEKDUMP_INDEX_ENTRY* index;
+    DECOMPRESSOR_HANDLE decompressor;
+    BYTE* compressed;
+    DUMP_CACHE_SLOT* cache;
+    DWORD cacheSlots;
+    DWORD64 tick;
+    MINIDUMP_THREAD* threads;
+    ULONG32 threadCount;
+    DUMP_MEMORY_RANGE* ranges;
+    ULONG32 rangeCount;
+    DUMP_MODULE* modules;
+    ULONG32 moduleCount;
+    BYTE* snapshot;
+    MODULE_CACHE* moduleCache;
+    DUMP_READER_STATS stats;
+} DUMP_READER;
+
+UNWINDER_API void close_dump(DUMP_READER* reader);
+
+static BOOL read_file_at(HANDLE file, DWORD64 offset, void* buffer, DWORD size) {
+    OVERLAPPED ov = {0};
+    ov.Offset = (DWORD)offset;
+    ov.OffsetHigh = (DWORD)(offset >> 32);
+
+    DWORD bytesRead = 0;
+    if (!ReadFile(file, buffer, size, &bytesRead, &ov)) return FALSE;
+    return bytesRead == size;
+}
+
+static BOOL write_file_all(HANDLE file, const void* buffer, DWORD size) {
+    DWORD written = 0;
+    if (!WriteFile(file, buffer, size, &written, NULL)) return FALSE;
+    return written == size;
+}
+
+/* Blocks needed to hold size bytes; FALSE if they would not fit an index. */
+static BOOL seekdump_block_count(DWORD64 size, DWORD blockSize, DWORD* count) {
+    DWORD64 blocks = size / blockSize + (size % blockSize != 0);
+    if (blocks > MAXDWORD / sizeof(SEEKDUMP_INDEX_ENTRY)) return FALSE;
+    *count = (DWORD)blocks;
+    return TRUE;
+}
+
+static DWORD seekdump_block_length(DUMP_READER* reader, DWORD block) {
+    DWORD64 start = (DWORD64)block * reader->header.BlockSize;
+    DWORD64 remaining = reader->header.UncompressedSize - start;
+    return remaining < reader->header.BlockSize ? (DWORD)remaining : reader->header.BlockSize;
+}
+
+static BYTE* load_block(DUMP_READER* reader, DWORD block) {
+    DUMP_CACHE_SLOT* victim = &reader->cache[0];
+    if (block >= reader->header.BlockCount) {
+        set_error(14, "Dump block out of range", block);
+        return NULL;
+    }
+
+    for (DWORD i = 0; i < reader->cacheSlots; i++) {
+        DUMP_CACHE_SLOT* slot = &reader->cache[i];
+        if (slot->block == block) {
+            slot->lastUse = ++reader->tick;
+            reader->stats.cacheHits++;
+            return slot->data;
+        }
+        if (victim->block != DUMP_CACHE_EMPTY &&
+            (slot->block == DUMP_CACHE_EMPTY || slot->lastUse < victim->lastUse)) {
+            victim = slot;
+        }
+    }
+
+    reader->stats.cacheMisses++;
+    victim->block = DUMP_CACHE_EMPTY;
+
+    DWORD length = seekdump_block_length(reader, block);
+    if (!reader->seekable) {
+        /* Plain dumps go through the same cache so both formats read alike. */
+        if (!read_file_at(reader->file, (DWORD64)block * reader->header.BlockSize, victim->data, length)) {
+            set_error(14, "Failed to read dump block", block);
+            return NULL;
+        }
+        victim->block = block;
+        victim->lastUse = ++reader->tick;
+        return victim->data;
+    }
+
+    SEEKDUMP_INDEX_ENTRY* entry = &reader->index[block];
+    if (entry->Flags & SEEKDUMP_BLOCK_STORED) {
+        if (entry->CompressedSize != length ||
+            !read_file_at(reader->file, entry->Offset, victim->data, length)) {
+            set_error(14, "Failed to read stored dump block", block);
+            return NULL;
+        }
+    } else {
+        SIZE_T decompressed = 0;
+        if (entry->CompressedSize > reader->header.BlockSize ||
+            !read_file_at(reader->file, entry->Offset, reader->compressed, entry->CompressedSize) ||
+            !Decompress(reader->decompressor, reader->compressed, entry->CompressedSize,
+                        victim->data, length, &decompressed) ||
+            decompressed != length) {
+            set_error(14, "Failed to decompress dump block", block);
+            return NULL;
+        }
+    }
+
+    reader->stats.blocksDecompressed++;
+    reader->stats.bytesDecompressed += length;
+    victim->block = block;
+    victim->lastUse = ++reader->tick;
+    return victim->data;
+}
+
+static BOOL read_dump_bytes(DUMP_READER* reader, DWORD64 offset, void* buffer, DWORD size) {
+    if (offset > reader->stats.dumpSize || size > reader->stats.dumpSize - offset) {
+        return FALSE;
+    }
+    reader->stats.bytesRead += size;
+
+    if (reader->snapshot) {
+        memcpy(buffer, reader->snapshot + offset, size);
+        return TRUE;
+    }
+
+    BYTE* out = (BYTE*)buffer;
+    while (size > 0) {
+        DWORD block = (DWORD)(offset / reader->header.BlockSize);
+        DWORD blockOffset = (DWORD)(offset % reader->header.BlockSize);
+        DWORD chunk = seekdump_block_length(reader, block) - blockOffset;
+        if (chunk > size) chunk = size;
+
+        BYTE* data = load_block(reader, block);
+        if (!data) return FALSE;
+
+        memcpy(out, data + blockOffset, chunk);
+        out += chunk;
+        offset += chunk;
+        size -= chunk;
+    }
+    return TRUE;
+}
+
+static void* read_dump_array(DUMP_READER* reader, DWORD64 offset, ULONG64 count, size_t elementSize) {
+    if (count == 0 || count > MAXDWORD / elementSize) return NULL;
+
+    void* items = malloc((size_t)count * elementSize);
+    if (items && !read_dump_bytes(reader, offset, items, (DWORD)(count * elementSize))) {
+        free(items);
+        return NULL;
+    }
+    return items;
+}
+
+static int compare_memory_ranges(const void* a, const void* b) {
+    DWORD64 left = ((const DUMP_MEMORY_RANGE*)a)->start;
+    DWORD64 right = ((const DUMP_MEMORY_RANGE*)b)->start;
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+static BOOL add_memory_ranges(DUMP_READER* reader, const DUMP_MEMORY_RANGE* ranges, ULONG32 count) {
+    DUMP_MEMORY_RANGE* grown = (DUMP_MEMORY_RANGE*)realloc(
+        reader->ranges, ((size_t)reader->rangeCount + count) * sizeof(DUMP_MEMORY_RANGE));
+    if (!grown) return FALSE;
+
+    memcpy(grown + reader->rangeCount, ranges, count * sizeof(DUMP_MEMORY_RANGE));
+    reader->ranges = grown;
+    reader->rangeCount += count;
+    return TRUE;
+}
+
+static BOOL parse_memory_list(DUMP_READER* reader, MINIDUMP_DIRECTORY* stream) {
+    ULONG32 count = 0;
+    if (!read_dump_bytes(reader, stream->Location.Rva, &count, sizeof(count))) return FALSE;
+    if (count == 0) return TRUE;
+
+    MINIDUMP_MEMORY_DESCRIPTOR* descriptors = (MINIDUMP_MEMORY_DESCRIPTOR*)read_dump_array(
+        reader, stream->Location.Rva + sizeof(count), count, sizeof(MINIDUMP_MEMORY_DESCRIPTOR));
+    DUMP_MEMORY_RANGE* ranges = (DUMP_MEMORY_RANGE*)calloc(count, sizeof(DUMP_MEMORY_RANGE));
+    BOOL ok = descriptors && ranges;
+
+    for (ULONG32 i = 0; ok && i < count; i++) {
+        ranges[i].start = descriptors[i].StartOfMemoryRange;
+        ranges[i].size = descriptors[i].Memory.DataSize;
+        ranges[i].rva = descriptors[i].Memory.Rva;
+    }
+    if (ok) ok = add_memory_ranges(reader, ranges, count);
+
+    free(descriptors);
+    free(ranges);
+    return ok;
+}
+
+static BOOL parse_memory64_list(DUMP_READER* reader, MINIDUMP_DIRECTORY* stream) {
+    MINIDUMP_MEMORY64_LIST list = {0};
+    DWORD headerSize = sizeof(list.NumberOfMemoryRanges) + sizeof(list.BaseRva);
+    if (!read_dump_bytes(reader, stream->Location.Rva, &list, headerSize)) return FALSE;
+    if (list.NumberOfMemoryRanges == 0) return TRUE;
+
+    MINIDUMP_MEMORY_DESCRIPTOR64* descriptors = (MINIDUMP_MEMORY_DESCRIPTOR64*)read_dump_array(
+        reader, stream->Location.Rva + headerSize, list.NumberOfMemoryRanges,
+        sizeof(MINIDUMP_MEMORY_DESCRIPTOR64));
+    if (!descriptors) return FALSE;
+
+    ULONG32 count = (ULONG32)list.NumberOfMemoryRanges;
+    DUMP_MEMORY_RANGE* ranges = (DUMP_MEMORY_RANGE*)calloc(count, sizeof(DUMP_MEMORY_RANGE));
+    BOOL ok = ranges != NULL;
+
+    DWORD64 rva = list.BaseRva;
+    for (ULONG32 i = 0; ok && i < count; i++) {
+        ranges[i].start = descriptors[i].StartOfMemoryRange;
+        ranges[i].size = descriptors[i].DataSize;
+        ranges[i].rva = rva;
+        rva += descriptors[i].DataSize;
+    }
+    if (ok) ok = add_memory_ranges(reader, ranges, count);
+
+    free(descriptors);
+    free(ranges);
+    return ok;
+}
+
+/* FNV-1a over one character of a file name, folding ASCII case. */
+static DWORD64 hash_name_char(DWORD64 hash, DWORD c) {
+    if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+    return (hash ^ c) * MODULE_NAME_HASH_PRIME;
+}
+
+static DWORD64 module_name_hash(const char* path) {
+    const char* name = path;
+    for (const char* p = path; *p; p++) {
+        if (*p == '\\' || *p == '/') name = p + 1;
+    }
+
+    DWORD64 hash = MODULE_NAME_HASH_BASIS;
+    for (; *name; name++) hash = hash_name_char(hash, (BYTE)*name);
+    return hash;
+}
+
+static DWORD64 module_name_hash_wide(const WCHAR* path, DWORD length) {
+    DWORD start = 0;
+    for (DWORD i = 0; i < length; i++) {
+        if (path[i] == L'\\' || path[i] == L'/') start = i + 1;
+    }
+
+    DWORD64 hash = MODULE_NAME_HASH_BASIS;
+    for (DWORD i = start; i < length; i++) hash = hash_name_char(hash, path[i]);
+    return hash;
+}
+
+/*
+ * Timestamps of 0 come from reproducible-build toolchains, and builds made
+ * in the same second can share one, so without a timestamp or a name the
+ * module is not shared through the cache at all.
+ */
+static DWORD64 module_identity(DWORD64 nameHash, DWORD timeDateStamp, DWORD sizeOfImage, DWORD checkSum) {
+    if (nameHash == 0 || timeDateStamp == 0) return 0;
+
+    DWORD64 hash = nameHash;
+    hash = (hash ^ timeDateStamp) * MODULE_NAME_HASH_PRIME;
+    hash = (hash ^ sizeOfImage) * MODULE_NAME_HASH_PRIME;
+    hash = (hash ^ checkSum) * MODULE_NAME_HASH_PRIME;
+    return hash ? hash : 1;
+}
+
+/* Hashes the file name of a MINIDUMP_STRING path; 0 if it cannot be read. */
+static DWORD64 read_module_name_hash(DUMP_READER* reader, RVA nameRva) {
+    ULONG32 length = 0;
+    if (!read_dump_bytes(reader, nameRva, &length, sizeof(length))) return 0;
+
+    /* Only the tail matters for the file name. */
+    WCHAR name[MODULE_NAME_MAX_CHARS];
+    DWORD chars = length / sizeof(WCHAR);
+    DWORD skip = chars > MODULE_NAME_MAX_CHARS ? chars - MODULE_NAME_MAX_CHARS : 0;
+    chars -= skip;
+    if (!read_dump_bytes(reader, (DWORD64)nameRva + sizeof(length) + (DWORD64)skip * sizeof(WCHAR),
+                         name, chars * sizeof(WCHAR))) {
+        return 0;
+    }
+    return module_name_hash_wide(name, chars);
+}
+
+static BOOL parse_module_list(DUMP_READER* reader, MINIDUMP_DIRECTORY* stream) {
+    ULONG32 count = 0;
+    if (!read_dump_bytes(reader, stream->Location.Rva, &count, sizeof(count))) return FALSE;
+    if (count == 0) return TRUE;
+
+    MINIDUMP_MODULE* modules = (MINIDUMP_MODULE*)read_dump_array(
+        reader, stream->Location.Rva + sizeof(count), count, sizeof(MINIDUMP_MODULE));
+    reader->modules = (DUMP_MODULE*)calloc(count, sizeof(DUMP_MODULE));
+    if (!modules || !reader->modules) {
+        free(modules);
+        return FALSE;
+    }
+
+    for (ULONG32 i = 0; i < count; i++) {
+        reader->modules[i].base = modules[i].BaseOfImage;
+        reader->modules[i].size = modules[i].SizeOfImage;
+        reader->modules[i].timeDateStamp = modules[i].TimeDateStamp;
+        reader->modules[i].checkSum = modules[i].CheckSum;
+        reader->modules[i].identity = module_identity(read_module_name_hash(reader, modules[i].ModuleNameRva),
+                                                      modules[i].TimeDateStamp, modules[i].SizeOfImage,
+                                                      modules[i].CheckSum);
+    }
+    reader->moduleCount = count;
+
+    free(modules);
+    return TRUE;
+}
+
+static BOOL parse_thread_list(DUMP_READER* reader, MINIDUMP_DIRECTORY* stream) {
+    ULONG32 count = 0;
+    if (!read_dump_bytes(reader, stream->Location.Rva, &count, sizeof(count))) return FALSE;
+    if (count == 0) return TRUE;
+
+    reader->threads = (MINIDUMP_THREAD*)read_dump_array(
+        reader, stream->Location.Rva + sizeof(count), count, sizeof(MINIDUMP_THREAD));
+    if (!reader->threads) return FALSE;
+
+    reader->threadCount = count;
+    return TRUE;
+}
+
+static BOOL parse_minidump(DUMP_READER* reader) {
+    MINIDUMP_HEADER header = {0};
+    if (!read_dump_bytes(reader, 0, &header, sizeof(header)) ||
+        header.Signature != MINIDUMP_SIGNATURE) {
+        set_error(12, "Not a minidump", 0);
+        return FALSE;
+    }
+
+    if (header.NumberOfStreams > 1000) {
+        debug_print(UW_DEBUG_ERROR, "Unreasonable stream count: %lu\n", header.NumberOfStreams);
+        set_error(12, "Corrupt minidump stream directory", 0);
+        return FALSE;
+    }
+
+    MINIDUMP_DIRECTORY* streams = (MINIDUMP_DIRECTORY*)read_dump_array(
+        reader, header.StreamDirectoryRva, header.NumberOfStreams, sizeof(MINIDUMP_DIRECTORY));
+    if (!streams) {
+        set_error(12, "Failed to read minidump stream directory", 0);
+        return FALSE;
+    }
+
+    BOOL ok = TRUE;
+    for (ULONG32 i = 0; ok && i < header.NumberOfStreams; i++) {
+        switch (streams[i].StreamType) {
+            case ThreadListStream:
+                ok = parse_thread_list(reader, &streams[i]);
+                break;
+            case ModuleListStream:
+                ok = parse_module_list(reader, &streams[i]);
+                break;
+            case MemoryListStream:
+                ok = parse_memory_list(reader, &streams[i]);
+                break;
+            case Memory64ListStream:
+                ok = parse_memory64_list(reader, &streams[i]);
+                break;
+        }
+    }
+    free(streams);
+
+    if (!ok) {
+        set_error(12, "Failed to parse minidump streams", 0);
+        return FALSE;
+    }
+
+    if (reader->rangeCount) {
+        qsort(reader->ranges, reader->rangeCount, sizeof(DUMP_MEMORY_RANGE), compare_memory_ranges);
+    }
+
+    debug_print(UW_DEBUG_INFO, "Dump has %lu threads, %lu modules, %lu memory ranges\n",
+                reader->threadCount, reader->moduleCount, reader->rangeCount);
+    return TRUE;
+}
+
+static BOOL init_block_cache(DUMP_READER* reader, DWORD cacheBlocks) {
+    reader->cacheSlots = cacheBlocks ? cacheBlocks : SEEKDUMP_DEFAULT_CACHE_BLOCKS;
+    reader->cache = (DUMP_CACHE_SLOT*)calloc(reader->cacheSlots, sizeof(DUMP_CACHE_SLOT));
+    if (!reader->cache) return FALSE;
+
+    for (DWORD i = 0; i < reader->cacheSlots; i++) {
+        reader->cache[i].block = DUMP_CACHE_EMPTY;
+        reader->cache[i].data = (BYTE*)malloc(reader->header.BlockSize);
+        if (!reader->cache[i].data) return FALSE;
+    }
+
+    reader->stats.dumpSize = reader->header.UncompressedSize;
+    return TRUE;
+}
+
+static BOOL open_seekable_container(DUMP_READER* reader, DWORD cacheBlocks) {
+    SEEKDUMP_HEADER* header = &reader->header;
+    DWORD blockCount = 0;
+    if (!read_file_at(reader->file, 0, header, sizeof(*header)) ||
+        header->Version != SEEKDUMP_VERSION ||
+        header->Algorithm != SEEKDUMP_ALGORITHM ||
+        header->BlockSize == 0 || header->BlockSize > SEEKDUMP_MAX_BLOCK_SIZE ||
+        header->BlockCount == 0 ||
+        !seekdump_block_count(header->UncompressedSize, header->BlockSize, &blockCount) ||
+        header->BlockCount != blockCount) {
+        set_error(13, "Corrupt seekable dump header", 0);
+        return FALSE;
+    }
+
+    reader->index = (SEEKDUMP_INDEX_ENTRY*)calloc(header->BlockCount, sizeof(SEEKDUMP_INDEX_ENTRY));
+    if (!reader->index ||
+        !read_file_at(reader->file, header->IndexOffset, reader->index,
+                      header->BlockCount * sizeof(SEEKDUMP_INDEX_ENTRY))) {
+        set_error(13, "Failed to read seekable dump index", 0);
+        return FALSE;
+    }
+
+    if (!CreateDecompressor(SEEKDUMP_ALGORITHM, NULL, &reader->decompressor)) {
+        set_error(13, "Failed to create decompressor", GetLastError());
+        return FALSE;
+    }
+
+    reader->compressed = (BYTE*)malloc(header->BlockSize);
+    if (!reader->compressed || !init_block_cache(reader, cacheBlocks)) return FALSE;
+
+    reader->seekable = TRUE;
+    return TRUE;
+}
+
+UNWINDER_API DUMP_READER* open_dump(const char* path, DWORD cacheBlocks) {
+    if (!path) return NULL;
+
+    DUMP_READER* reader = (DUMP_READER*)calloc(1, sizeof(DUMP_READER));
+    if (!reader) return NULL;
+
+    reader->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                               OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+    if (reader->file == INVALID_HANDLE_VALUE) {
+        set_error(11, "Failed to open dump file", GetLastError());
+        free(reader);
+        return NULL;
+    }
+
+    DWORD signature = 0;
+    LARGE_INTEGER fileSize = {0};
+    if (!read_file_at(reader->file, 0, &signature, sizeof(signature)) ||
+        !GetFileSizeEx(reader->file, &fileSize)) {
+        set_error(11, "Failed to read dump file", GetLastError());
+        close_dump(reader);
+        return NULL;
+    }
+
+    if (signature == SEEKDUMP_SIGNATURE) {
+        if (!open_seekable_container(reader, cacheBlocks)) {
+            close_dump(reader);
+            return NULL;
+        }
+    } else {
+        reader->header.BlockSize = SEEKDUMP_DEFAULT_BLOCK_SIZE;
+        reader->header.UncompressedSize = (DWORD64)fileSize.QuadPart;
+        if (!seekdump_block_count(reader->header.UncompressedSize, reader->header.BlockSize,
+                                  &reader->header.BlockCount) ||
+            !init_block_cache(reader, cacheBlocks)) {
+            close_dump(reader);
+            return NULL;
+        }
+    }
+
+    if (!parse_minidump(reader)) {
+        close_dump(reader);
+        return NULL;
+    }
+    return reader;
+}
+
+UNWINDER_API void close_dump(DUMP_READER* reader) {
+    if (!reader) return;
+
+    if (reader->cache) {
+        for (DWORD i = 0; i < reader->cacheSlots; i++) {
+            free(reader->cache[i].data);
+        }
+        free(reader->cache);
+    }
+    if (reader->decompressor) CloseDecompressor(reader->decompressor);
+    if (reader->file != INVALID_HANDLE_VALUE) CloseHandle(reader->file);
+
+    for (ULONG32 i = 0; i < reader->moduleCount; i++) {
+        if (reader->modules[i].imageHandle) FreeLibrary(reader->modules[i].imageHandle);
+        free(reader->modules[i].path);
+    }
+
+    free(reader->snapshot);
+    free(reader->compressed);
+    free(reader->index);
+    free(reader->threads);
+    free(reader->ranges);
+    free(reader->modules);
+    free(reader);
+}
+
+UNWINDER_API BOOL get_dump_stats(DUMP_READER* reader, DUMP_READER_STATS* stats) {
+    if (!reader || !stats) return FALSE;
+    *stats = reader->stats;
+    return TRUE;
+}
+
+UNWINDER_API DWORD get_dump_thread_count(DUMP_READER* reader) {
+    return reader ? reader->threadCount : 0;
+}
+
+UNWINDER_API BOOL get_dump_thread_context(DUMP_READER* reader, DWORD threadIndex, CONTEXT* ctx) {
+    if (!reader || !ctx || threadIndex >= reader->threadCount) return FALSE;
+
+    MINIDUMP_LOCATION_DESCRIPTOR* location = &reader->threads[threadIndex].ThreadContext;
+    DWORD size = location->DataSize < sizeof(CONTEXT) ? location->DataSize : sizeof(CONTEXT);
+
+    memset(ctx, 0, sizeof(CONTEXT));
+    if (!read_dump_bytes(reader, location->Rva, ctx, size)) {
+        set_error(15, "Failed to read thread context", threadIndex);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static DUMP_MEMORY_RANGE* find_memory_range(DUMP_READER* reader, DWORD64 address) {
+    ULONG32 low = 0, high = reader->rangeCount;
+    while (low < high) {
+        ULONG32 mid = low + (high - low) / 2;
+        if (reader->ranges[mid].start <= address) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == 0) return NULL;
+
+    DUMP_MEMORY_RANGE* range = &reader->ranges[low - 1];
+    return address - range->start < range->size ? range : NULL;
+}
+
+static DWORD module_cache_hash(DWORD64 module, DWORD64 key) {
+    DWORD64 h = (module ^ (key * 0x9E3779B97F4A7C15ULL)) * 0xFF51AFD7ED558CCDULL;
+    return (DWORD)(h >> 32) & (MODULE_CACHE_BUCKETS - 1);
+}
+
+static MODULE_CACHE_ENTRY* module_cache_find(MODULE_CACHE* cache, DWORD64 module, DWORD64 key) {
+    MODULE_CACHE_ENTRY* entry = cache->buckets[module_cache_hash(module, key)];
+    while (entry && (entry->module != module || entry->key != key)) {
+        entry = entry->hashNext;
+    }
+    return entry;
+}
+
+static void module_cache_lru_unlink(MODULE_CACHE* cache, MODULE_CACHE_ENTRY* entry) {
+    if (entry->lruPrev) entry->lruPrev->lruNext = entry->lruNext;
+    else cache->lruHead = entry->lruNext;
+    if (entry->lruNext) entry->lruNext->lruPrev = entry->lruPrev;
+    else cache->lruTail = entry->lruPrev;
+    entry->lruPrev = entry->lruNext = NULL;
+}
+
+static void module_cache_lru_push(MODULE_CACHE* cache, MODULE_CACHE_ENTRY* entry) {
+    entry->lruNext = cache->lruHead;
+    if (cache->lruHead) cache->lruHead->lruPrev = entry;
+    cache->lruHead = entry;
+    if (!cache->lruTail) cache->lruTail = entry;
+}
+
+static void module_cache_touch(MODULE_CACHE* cache, MODULE_CACHE_ENTRY* entry) {
+    if (cache->lruHead == entry) return;
+    module_cache_lru_unlink(cache, entry);
+    module_cache_lru_push(cache, entry);
+}
+
+static void module_cache_remove(MODULE_CACHE* cache, MODULE_CACHE_ENTRY* entry) {
+    MODULE_CACHE_ENTRY** link = &cache->buckets[module_cache_hash(entry->module, entry->key)];
+    while (*link != entry) link = &(*link)->hashNext;
+    *link = entry->hashNext;
+
+    module_cache_lru_unlink(cache, entry);
+    cache->stats.bytesUsed -= entry->size + sizeof(MODULE_CACHE_ENTRY);
+    cache->stats.entries--;
+    free(entry->data);
+    free(entry);
+}
+
+/* Copies part of a cached entry out under the lock; FALSE is a miss. */
+static BOOL module_cache_read(MODULE_CACHE* cache, DWORD64 module, DWORD64 key,
+                              SIZE_T offset, void* buffer, SIZE_T size) {
+    BOOL hit = FALSE;
+    AcquireSRWLockExclusive(&cache->lock);
+
+    MODULE_CACHE_ENTRY* entry = module_cache_find(cache, module, key);
+    if (entry && offset <= entry->size && size <= entry->size - offset) {
+        memcpy(buffer, entry->data + offset, size);
+        module_cache_touch(cache, entry);
+        hit = TRUE;
+    }
+    if (hit) cache->stats.hits++;
+    else cache->stats.misses++;
+
+    ReleaseSRWLockExclusive(&cache->lock);
+    return hit;
+}
+
+/* No single entry may take more than an eighth of the budget. The budget never changes. */
+static BOOL module_cache_admits(MODULE_CACHE* cache, SIZE_T size) {
+    return size + sizeof(MODULE_CACHE_ENTRY) <= cache->stats.budget / 8;
+}
+
+/* Adds an entry that is known to be admissible and absent; the lock is held exclusively. */
+static void module_cache_add_locked(MODULE_CACHE* cache, DWORD64 module, DWORD64 key,
+                                    const void* data, SIZE_T size) {
+    SIZE_T cost = size + sizeof(MODULE_CACHE_ENTRY);
+    while (cache->lruTail && cache->stats.bytesUsed + cost > cache->stats.budget) {
+        module_cache_remove(cache, cache->lruTail);
+        cache->stats.evictions++;
+    }
+
+    MODULE_CACHE_ENTRY* entry = (MODULE_CACHE_ENTRY*)calloc(1, sizeof(MODULE_CACHE_ENTRY));
+    BYTE* copy = size ? (BYTE*)malloc(size) : NULL;
+    if (entry && (copy || !size)) {
+        if (size) memcpy(copy, data, size);
+        entry->module = module;
+        entry->key = key;
+        entry->size = size;
+        entry->data = copy;
+
+        DWORD bucket = module_cache_hash(module, key);
+        entry->hashNext = cache->buckets[bucket];
+        cache->buckets[bucket] = entry;
+        module_cache_lru_push(cache, entry);
+        cache->stats.bytesUsed += cost;
+        cache->stats.entries++;
+    } else {
+        free(entry);
+        free(copy);
+    }
+}
+
+/*
+ * Admission is size-aware: an entry larger than an eighth of the budget
+ * would flush most of the cache for a single module, so it is not kept.
+ * Otherwise least recently used entries are evicted until it fits.
+ */
+static void module_cache_insert(MODULE_CACHE* cache, DWORD64 module, DWORD64 key,
+                                const void* data, SIZE_T size) {
+    AcquireSRWLockExclusive(&cache->lock);
+
+    if (!module_cache_admits(cache, size)) {
+        cache->stats.rejected++;
+    } else if (!module_cache_find(cache, module, key)) {
+        module_cache_add_locked(cache, module, key, data, size);
+    }
+
+    ReleaseSRWLockExclusive(&cache->lock);
+}
+
+/*
+ * Records that a module's function table is too large to keep, as an empty
+ * entry under the table's key, so the table is counted as rejected once
+ * and later lookups go straight to the in-place search.
+ */
+static void module_cache_reject_functions(MODULE_CACHE* cache, DWORD64 module) {
+    DWORD64 key = (DWORD64)MODULE_CACHE_FUNCTIONS << 32;
+    AcquireSRWLockExclusive(&cache->lock);
+
+    if (!module_cache_find(cache, module, key)) {
+        cache->stats.rejected++;
+        module_cache_add_locked(cache, module, key, NULL, 0);
+    }
+
+    ReleaseSRWLockExclusive(&cache->lock);
+}
+
+static const RUNTIME_FUNCTION* search_function_table(const RUNTIME_FUNCTION* table, DWORD count, DWORD rva) {
+    DWORD low = 0, high = count;
+    while (low < high) {
+        DWORD mid = low + (high - low) / 2;
+        if (rva < table[mid].BeginAddress) {
+            high = mid;
+        } else if (rva >= table[mid].EndAddress) {
+            low = mid + 1;
+        } else {
+            return &table[mid];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Looks up rva in a cached function table. Returns FALSE if the table is
+ * not cached; *refused is set when it was already found too large, which
+ * is neither a hit nor a miss.
+ */
+static BOOL module_cache_find_function(MODULE_CACHE* cache, DWORD64 module, DWORD rva,
+                                       RUNTIME_FUNCTION* rfn, BOOL* found, BOOL* refused) {
+    BOOL hit = FALSE;
+    *refused = FALSE;
+    AcquireSRWLockExclusive(&cache->lock);
+
+    MODULE_CACHE_ENTRY* entry = module_cache_find(cache, module, (DWORD64)MODULE_CACHE_FUNCTIONS << 32);
+    if (entry && entry->size == 0) {
+        module_cache_touch(cache, entry);
+        *refused = TRUE;
+        ReleaseSRWLockExclusive(&cache->lock);
+        return FALSE;
+    }
+    if (entry) {
+        const RUNTIME_FUNCTION* match = search_function_table(
+            (const RUNTIME_FUNCTION*)entry->data, (DWORD)(entry->size / sizeof(RUNTIME_FUNCTION)), rva);
+        if (match) *rfn = *match;
+        *found = match != NULL;
+        module_cache_touch(cache, entry);
+        hit = TRUE;
+    }
+    if (hit) cache->stats.hits++;
+    else cache->stats.misses++;
+
+    ReleaseSRWLockExclusive(&cache->lock);
+    return hit;
+}
+
+static BYTE* map_module_image(DUMP_MODULE* module, HMODULE* handle) {
+    const char* path = module->path;
+    HMODULE mapped = LoadLibraryExA(path, NULL, LOAD_LIBRARY_AS_IMAGE_RESOURCE | LOAD_LIBRARY_AS_DATAFILE);
+    if (!mapped) {
+        debug_print(UW_DEBUG_WARN, "Failed to map module %s: %lu\n", path, GetLastError());
+        return NULL;
+    }
+
+    /* Resource-only handles carry flag bits in the low bits. */
+    BYTE* image = (BYTE*)((ULONG_PTR)mapped & ~(ULONG_PTR)3);
+    IMAGE_NT_HEADERS64* nt = (IMAGE_NT_HEADERS64*)(image + ((IMAGE_DOS_HEADER*)image)->e_lfanew);
+    if (nt->OptionalHeader.Magic != IMAGE_NT_OPTIONAL_HDR64_MAGIC ||
+        nt->FileHeader.TimeDateStamp != module->timeDateStamp ||
+        nt->OptionalHeader.SizeOfImage != module->size ||
+        nt->OptionalHeader.CheckSum != module->checkSum) {
+        debug_print(UW_DEBUG_WARN, "Module %s does not match the requested build\n", path);
+        FreeLibrary(mapped);
+        return NULL;
+    }
+
+    *handle = mapped;
+    return image;
+}
+
+UNWINDER_API MODULE_CACHE* create_module_cache(SIZE_T budget) {
+    MODULE_CACHE* cache = (MODULE_CACHE*)calloc(1, sizeof(MODULE_CACHE));
+    if (!cache) return NULL;
+
+    InitializeSRWLock(&cache->lock);
+    cache->stats.budget = budget;
+    return cache;
+}
+
+UNWINDER_API void destroy_module_cache(MODULE_CACHE* cache) {
+    if (!cache) return;
+    while (cache->lruTail) {
+        module_cache_remove(cache, cache->lruTail);
+    }
+    free(cache);
+}
+
+UNWINDER_API BOOL get_module_cache_stats(MODULE_CACHE* cache, MODULE_CACHE_STATS* stats) {
+    if (!cache || !stats) return FALSE;
+
+    AcquireSRWLockShared(&cache->lock);
+    *stats = cache->stats;
+    ReleaseSRWLockShared(&cache->lock);
+    return TRUE;
+}
+
+UNWINDER_API BOOL attach_module_cache(DUMP_READER* reader, MODULE_CACHE* cache) {
+    if (!reader) return FALSE;
+    reader->moduleCache = cache;
+    return TRUE;
+}
+
+static BOOL read_range_memory(DUMP_READER* reader, DWORD64 address, void* buffer, DWORD size) {
+    BYTE* out = (BYTE*)buffer;
+    while (size > 0) {
+        DUMP_MEMORY_RANGE* range = find_memory_range(reader, address);
+        if (!range) return FALSE;
+
+        DWORD64 offset = address - range->start;
+        DWORD64 available = range->size - offset;
+        DWORD chunk = available < size ? (DWORD)available : size;
+
+        if (!read_dump_bytes(reader, range->rva + offset, out, chunk)) return FALSE;
+        out += chunk;
+        address += chunk;
+        size -= chunk;
+    }
+    return TRUE;
+}
+
+static DUMP_MODULE* find_dump_module(DUMP_READER* reader, DWORD64 address) {
+    for (ULONG32 i = 0; i < reader->moduleCount; i++) {
+        if (address - reader->modules[i].base < reader->modules[i].size) {
+            return &reader->modules[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Snapshot modules are mapped only when a read misses the module cache,
+ * and unmapped when the reader closes, so a long-running host does not
+ * keep client images mapped.
+ */
+static BOOL map_snapshot_module(DUMP_MODULE* module) {
+    module->image = map_module_image(module, &module->imageHandle);
+    if (!module->image) {
+        free(module->path);
+        module->path = NULL;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static BOOL read_module_source(DUMP_READER* reader, DUMP_MODULE* module,
+                               DWORD64 address, void* buffer, DWORD size) {
+    if (!module->image && module->path && !map_snapshot_module(module)) return FALSE;
+    if (module->image) {
+        memcpy(buffer, module->image + (address - module->base), size);
+        return TRUE;
+    }
+    return read_range_memory(reader, address, buffer, size);
+}
+
+static BOOL is_snapshot_module(DUMP_MODULE* module) {
+    return module->image != NULL || module->path != NULL;
+}
+
+/*
+ * Image headers, .pdata, .xdata and epilog code reads made by the unwinder.
+ * These go a page at a time through the shared module cache; the pages may
+ * have been captured from another dump or snapshot of the same build. That
+ * is only safe for read-only bytes the unwinder interprets without
+ * relocations, so read_dump_memory never uses the cache.
+ */
+static BOOL read_unwind_memory(DUMP_READER* reader, DWORD64 address, void* buffer, DWORD size) {
+    DUMP_MODULE* module = find_dump_module(reader, address);
+    if (!module || size > module->size - (address - module->base)) {
+        return read_range_memory(reader, address, buffer, size);
+    }
+    if (!reader->moduleCache || !module->identity) {
+        return read_module_source(reader, module, address, buffer, size);
+    }
+
+    BYTE page[MODULE_CACHE_PAGE_SIZE];
+    BYTE* out = (BYTE*)buffer;
+    while (size > 0) {
+        DWORD rva = (DWORD)(address - module->base);
+        DWORD pageRva = rva & ~(MODULE_CACHE_PAGE_SIZE - 1);
+        DWORD pageOffset = rva - pageRva;
+        DWORD pageSize = module->size - pageRva < MODULE_CACHE_PAGE_SIZE ?
+                         module->size - pageRva : MODULE_CACHE_PAGE_SIZE;
+        DWORD chunk = pageSize - pageOffset < size ? pageSize - pageOffset : size;
+        DWORD64 key = ((DWORD64)MODULE_CACHE_PAGE << 32) | pageRva;
+
+        if (!module_cache_read(reader->moduleCache, module->identity, key, pageOffset, out, chunk)) {
+            if (read_module_source(reader, module, module->base + pageRva, page, pageSize)) {
+                module_cache_insert(reader->moduleCache, module->identity, key, page, pageSize);
+                memcpy(out, page + pageOffset, chunk);
+            } else if (!read_module_source(reader, module, address, out, chunk)) {
+                return FALSE;
+            }
+        }
+
+        out += chunk;
+        address += chunk;
+        size -= chunk;
+    }
+    return TRUE;
+}
+
+/* Returns only this reader's bytes: dump memory ranges, or its own snapshot modules. */
+UNWINDER_API BOOL read_dump_memory(DUMP_READER* reader, DWORD64 address, void* buffer, DWORD size) {
+    if (!reader || !buffer) return FALSE;
+
+    DUMP_MODULE* module = find_dump_module(reader, address);
+    if (module && is_snapshot_module(module) && size <= module->size - (address - module->base)) {
+        return read_module_source(reader, module, address, buffer, size);
+    }
+    return read_range_memory(reader, address, buffer, size);
+}
+
+static void resolve_module_pdata(DUMP_READER* reader, DUMP_MODULE* module) {
+    module->pdataResolved = TRUE;
+
+    IMAGE_DOS_HEADER dos = {0};
+    IMAGE_NT_HEADERS64 nt = {0};
+    if (!read_unwind_memory(reader, module->base, &dos, sizeof(dos)) ||
+        dos.e_magic != IMAGE_DOS_SIGNATURE ||
+        !read_unwind_memory(reader, module->base + dos.e_lfanew, &nt, sizeof(nt)) ||
+        nt.Signature != IMAGE_NT_SIGNATURE ||
+        nt.OptionalHeader.Magic != IMAGE_NT_OPTIONAL_HDR64_MAGIC) {
+        debug_print(UW_DEBUG_WARN, "Module at 0x%p has no image in dump\n", (PVOID)module->base);
+        return;
+    }
+
+    IMAGE_DATA_DIRECTORY* dir = &nt.OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXCEPTION];
+    if (dir->VirtualAddress > module->size || dir->Size > module->size - dir->VirtualAddress) {
+        debug_print(UW_DEBUG_WARN, "Module at 0x%p has a bad exception directory\n", (PVOID)module->base);
+        return;
+    }
+    module->pdataRva = dir->VirtualAddress;
+    module->pdataSize = dir->Size;
+}
+
+static BOOL lookup_dump_function(DUMP_READER* reader, DUMP_MODULE* module, DWORD64 address,
+                                 RUNTIME_FUNCTION* rfn) {
+    if (!module->pdataResolved) resolve_module_pdata(reader, module);
+    if (module->pdataSize < sizeof(RUNTIME_FUNCTION)) return FALSE;
+
+    DWORD rva = (DWORD)(address - module->base);
+    DWORD count = module->pdataSize / sizeof(RUNTIME_FUNCTION);
+
+    if (reader->moduleCache && module->identity) {
+        BOOL found = FALSE, refused = FALSE;
+        if (module_cache_find_function(reader->moduleCache, module->identity, rva, rfn, &found, &refused)) {
+            return found;
+        }
+
+        /*
+         * Miss: pull the whole table once so later requests search it in
+         * memory. A table the cache would refuse is recorded as refused and
+         * searched in place below, where its pages still go through the
+         * page cache.
+         */
+        DWORD tableSize = count * sizeof(RUNTIME_FUNCTION);
+        RUNTIME_FUNCTION* table = NULL;
+        if (!refused && module_cache_admits(reader->moduleCache, tableSize)) {
+            table = (RUNTIME_FUNCTION*)malloc(tableSize);
+        } else if (!refused) {
+            module_cache_reject_functions(reader->moduleCache, module->identity);
+        }
+        if (table && read_module_source(reader, module, module->base + module->pdataRva, table, tableSize)) {
+            module_cache_insert(reader->moduleCache, module->identity,
+                                (DWORD64)MODULE_CACHE_FUNCTIONS << 32, table, tableSize);
+            const RUNTIME_FUNCTION* match = search_function_table(table, count, rva);
+            if (match) *rfn = *match;
+            free(table);
+            return match != NULL;
+        }
+        free(table);
+    }
+
+    DWORD low = 0, high = count;
+    while (low < high) {
+        DWORD mid = low + (high - low) / 2;
+        if (!read_unwind_memory(reader, module->base + module->pdataRva + mid * sizeof(RUNTIME_FUNCTION),
+                                rfn, sizeof(RUNTIME_FUNCTION))) {
+            return FALSE;
+        }
+
+        if (rva < rfn->BeginAddress) {
+            high = mid;
+        } else if (rva >= rfn->EndAddress) {
+            low = mid + 1;
+        } else {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static DWORD unwind_code_slots(UNWIND_INFO* info, UNWIND_CODE* code) {
+    switch (code->UnwindOp) {
+        case 1: return code->OpInfo == 0 ? 2 : 3;
+        case 4: return 2;
+        case 5: return 3;
+        case 6: return info->Version >= 2 ? 1 : 2;
+        case 7: return 3;
+        case 8: return 2;
+        case 9: return 3;
+        default: return 1;
+    }
+}
+
+#define EPILOG_MAX_BYTES 64
+
+/*
+ * Recognises the x64 epilog forms RtlVirtualUnwind accepts at RIP: an
+ * optional "add rsp, imm" or "lea rsp, [frame + disp]", any number of
+ * "pop reg", then "ret" or a jump out of the function. If RIP is inside
+ * one, the remaining instructions are executed against the stack instead
+ * of the unwind codes, which describe the prolog and would undo work the
+ * epilog already did. Code bytes come through read_unwind_memory; when the
+ * dump did not capture them the frame unwinds as if it were in the body.
+ */
+static BOOL emulate_dump_epilog(DUMP_READER* reader, DUMP_MODULE* module, const RUNTIME_FUNCTION* rfn,
+                                const UNWIND_INFO* info, CONTEXT* ctx) {
+    BYTE code[EPILOG_MAX_BYTES];
+    DWORD64 remaining = module->base + module->size - ctx->Rip;
+    DWORD available = remaining < sizeof(code) ? (DWORD)remaining : sizeof(code);
+    if (!read_unwind_memory(reader, ctx->Rip, code, available)) return FALSE;
+
+    CONTEXT out = *ctx;
+    DWORD64* regs = &out.Rax;
+    DWORD pos = 0;
+
+    if (available >= 4 && code[0] == 0x48 && code[1] == 0x83 && code[2] == 0xC4) {
+        out.Rsp += (signed char)code[3];
+        pos = 4;
+    } else if (available >= 7 && code[0] == 0x48 && code[1] == 0x81 && code[2] == 0xC4) {
+        out.Rsp += *(LONG*)&code[3];
+        pos = 7;
+    } else if (available >= 3 && (code[0] & 0xFE) == 0x48 && code[1] == 0x8D && (code[2] & 0x38) == 0x20) {
+        /* lea rsp, [reg + disp]: only valid against the function's frame register. */
+        BYTE mod = code[2] >> 6;
+        BYTE base = (code[2] & 7) | ((code[0] & 1) << 3);
+        DWORD dispSize = mod == 1 ? 1 : mod == 2 ? 4 : 0;
+        if (mod == 3 || (code[2] & 7) == 4 || (mod == 0 && (code[2] & 7) == 5) ||
+            !info->FrameRegister || base != info->FrameRegister || available < 3 + dispSize) {
+            return FALSE;
+        }
+        LONG disp = dispSize == 1 ? (signed char)code[3] : dispSize == 4 ? *(LONG*)&code[3] : 0;
+        out.Rsp = regs[base] + disp;
+        pos = 3 + dispSize;
+    }
+
+    /* Pops are only recorded here; the stack is read once the epilog is confirmed. */
+    BYTE pops[16];
+    DWORD popCount = 0;
+    while (popCount < 16) {
+        DWORD p = pos;
+        BYTE rex = (p < available && (code[p] & 0xF0) == 0x40) ? code[p++] : 0;
+        if (p >= available || (code[p] & 0xF8) != 0x58) break;
+        pops[popCount++] = (code[p] & 7) | ((rex & 1) << 3);
+        pos = p + 1;
+    }
+
+    BOOL isReturn = FALSE;
+    if (pos < available && code[pos] == 0xC3) {
+        isReturn = TRUE;
+    } else if (pos + 1 < available && code[pos] == 0xF3 && code[pos + 1] == 0xC3) {
+        isReturn = TRUE;
+    } else if (pos + 5 <= available && code[pos] == 0xE9) {
+        DWORD64 target = ctx->Rip + pos + 5 + *(LONG*)&code[pos + 1] - module->base;
+        isReturn = target < rfn->BeginAddress || target >= rfn->EndAddress;
+    } else if (pos + 2 <= available && code[pos] == 0xEB) {
+        DWORD64 target = ctx->Rip + pos + 2 + (signed char)code[pos + 1] - module->base;
+        isReturn = target < rfn->BeginAddress || target >= rfn->EndAddress;
+    } else if (pos + 2 <= available && code[pos] == 0xFF && code[pos + 1] == 0x25) {
+        isReturn = TRUE;
+    } else if (pos + 3 <= available && (code[pos] & 0xFE) == 0x48 && code[pos + 1] == 0xFF &&
+               ((code[pos + 2] >> 3) & 7) == 4) {
+        isReturn = TRUE;
+    }
+    if (!isReturn) return FALSE;
+
+    for (DWORD i = 0; i < popCount; i++) {
+        if (!read_dump_memory(reader, out.Rsp, &regs[pops[i]], sizeof(DWORD64))) return FALSE;
+        out.Rsp += 8;
+    }
+    if (!read_dump_memory(reader, out.Rsp, &out.Rip, sizeof(DWORD64))) return FALSE;
+    out.Rsp += 8;
+
+    *ctx = out;
+    return TRUE;
+}
+
+/*
+ * Virtually unwinds one frame of a dump or snapshot thread. This mirrors
+ * process_unwind_codes but reads through the reader instead of
+ * dereferencing live addresses, honours the prolog offset and emulates
+ * epilogs. dbghelp's StackWalk64 is single threaded, so the walker does
+ * not use it.
+ */
+static BOOL virtual_unwind_dump_frame(DUMP_READER* reader, CONTEXT* ctx) {
+    /* Rax..R15 are laid out in x64 register-number order. */
+    DWORD64* regs = &ctx->Rax;
+    DUMP_MODULE* module = find_dump_module(reader, ctx->Rip);
+    RUNTIME_FUNCTION rfn;
+
+    if (!module || !lookup_dump_function(reader, module, ctx->Rip, &rfn)) {
+        if (!read_dump_memory(reader, ctx->Rsp, &ctx->Rip, sizeof(DWORD64))) return FALSE;
+        ctx->Rsp += 8;
+        return TRUE;
+    }
+
+    RUNTIME_FUNCTION primary = rfn;
+    DWORD offset = (DWORD)(ctx->Rip - module->base - rfn.BeginAddress);
+    for (DWORD depth = 0; depth < 32; depth++) {
+        BYTE raw[sizeof(UNWIND_INFO) + 256 * sizeof(UNWIND_CODE) + sizeof(RUNTIME_FUNCTION)];
+        UNWIND_INFO* info = (UNWIND_INFO*)raw;
+        DWORD headerSize = sizeof(UNWIND_INFO) - sizeof(UNWIND_CODE);
+
+        if (!read_unwind_memory(reader, module->base + rfn.UnwindData, raw, headerSize)) return FALSE;
+
+        DWORD codesSize = ((info->CountOfCodes + 1) & ~1) * sizeof(UNWIND_CODE);
+        DWORD chainSize = (info->Flags & UNW_FLAG_CHAININFO) ? sizeof(RUNTIME_FUNCTION) : 0;
+        if (!read_unwind_memory(reader, module->base + rfn.UnwindData + headerSize,
+                                raw + headerSize, codesSize + chainSize)) {
+            return FALSE;
+        }
+
+        if (depth == 0 && offset >= info->SizeOfProlog &&
+            emulate_dump_epilog(reader, module, &primary, info, ctx)) {
+            return TRUE;
+        }
+
+        /* Saves are relative to the established frame, which may differ from RSP after alloca. */
+        for (DWORD i = 0; info->FrameRegister && i < info->CountOfCodes;
+             i += unwind_code_slots(info, &info->UnwindCode[i])) {
+            if (info->UnwindCode[i].UnwindOp == 3 && offset >= info->UnwindCode[i].CodeOffset) {
+                ctx->Rsp = regs[info->FrameRegister] - info->FrameOffset * 16;
+                break;
+            }
+        }
+
+        for (DWORD i = 0; i < info->CountOfCodes; i += unwind_code_slots(info, &info->UnwindCode[i])) {
+            UNWIND_CODE* code = &info->UnwindCode[i];
+            if (offset < code->CodeOffset) continue;
+
+            DWORD64 value = 0;
+            switch (code->UnwindOp) {
+                case 0:
+                    if (!read_dump_memory(reader, ctx->Rsp, &regs[code->OpInfo], sizeof(DWORD64))) return FALSE;
+                    ctx->Rsp += 8;
+                    break;
+                case 1:
+                    if (code->OpInfo == 0) {
+                        ctx->Rsp += (DWORD64)info->UnwindCode[i + 1].FrameOffset * 8;
+                    } else {
+                        ctx->Rsp += info->UnwindCode[i + 1].FrameOffset |
+                                    ((DWORD64)info->UnwindCode[i + 2].FrameOffset << 16);
+                    }
+                    break;
+                case 2:
+                    ctx->Rsp += (code->OpInfo + 1) * 8;
+                    break;
+                case 3:
+                    ctx->Rsp = regs[info->FrameRegister] - info->FrameOffset * 16;
+                    break;
+                case 4:
+                case 5:
+                    value = code->UnwindOp == 4 ?
+                            (DWORD64)info->UnwindCode[i + 1].FrameOffset * 8 :
+                            info->UnwindCode[i + 1].FrameOffset |
+                            ((DWORD64)info->UnwindCode[i + 2].FrameOffset << 16);
+                    if (!read_dump_memory(reader, ctx->Rsp + value, &regs[code->OpInfo], sizeof(DWORD64))) {
+                        return FALSE;
+                    }
+                    break;
+                case 10:
+                    ctx->Rsp += code->OpInfo ? 8 : 0;
+                    if (!read_dump_memory(reader, ctx->Rsp, &ctx->Rip, sizeof(DWORD64)) ||
+                        !read_dump_memory(reader, ctx->Rsp + 24, &value, sizeof(DWORD64))) {
+                        return FALSE;
+                    }
+                    ctx->Rsp = value;
+                    return TRUE;
+            }
+        }
+
+        if (!(info->Flags & UNW_FLAG_CHAININFO)) break;
+        memcpy(&rfn, raw + headerSize + codesSize, sizeof(RUNTIME_FUNCTION));
+        offset = MAXDWORD;
+    }
+
+    if (!read_dump_memory(reader, ctx->Rsp, &ctx->Rip, sizeof(DWORD64))) return FALSE;
+    ctx->Rsp += 8;
+    return TRUE;
+}
+
+UNWINDER_API BOOL walk_dump_thread(DUMP_READER* reader, DWORD threadIndex,
+                                   DWORD64* frames, DWORD maxFrames, DWORD* frameCount) {
+    if (!reader || !frames || !frameCount) return FALSE;
+    *frameCount = 0;
+
+    CONTEXT ctx;
+    if (!get_dump_thread_context(reader, threadIndex, &ctx)) return FALSE;
+
+    debug_print(UW_DEBUG_INFO, "Walking dump thread %lu from RIP=0x%p\n", threadIndex, (PVOID)ctx.Rip);
+
+    while (*frameCount < maxFrames && ctx.Rip != 0) {
+        frames[(*frameCount)++] = ctx.Rip;
+
+        DWORD64 previousRsp = ctx.Rsp;
+        if (!virtual_unwind_dump_frame(reader, &ctx) || ctx.Rsp <= previousRsp) break;
+    }
+
+    return *frameCount > 0;
+}
+
+/*
+ * Builds a reader over a register set and captured stack bytes instead of
+ * a dump file. The snapshot is laid out like a tiny dump, [stack][CONTEXT],
+ * so the rest of the reader works unchanged. Module images are mapped
+ * from disk only when a read misses the attached cache, and only if their
+ * headers match the given identity.
+ */
+UNWINDER_API DUMP_READER* open_stack_snapshot(const CONTEXT* ctx, DWORD64 stackBase,
+                                              const BYTE* stack, DWORD stackSize,
+                                              const SNAPSHOT_MODULE* modules, DWORD moduleCount) {
+    if (!ctx || (!stack && stackSize) || (!modules && moduleCount) ||
+        stackSize > MAXDWORD - sizeof(CONTEXT)) {
+        return NULL;
+    }
+
+    DUMP_READER* reader = (DUMP_READER*)calloc(1, sizeof(DUMP_READER));
+    if (!reader) return NULL;
+    reader->file = INVALID_HANDLE_VALUE;
+
+    reader->snapshot = (BYTE*)malloc(stackSize + sizeof(CONTEXT));
+    reader->threads = (MINIDUMP_THREAD*)calloc(1, sizeof(MINIDUMP_THREAD));
+    reader->ranges = (DUMP_MEMORY_RANGE*)calloc(1, sizeof(DUMP_MEMORY_RANGE));
+    reader->modules = (DUMP_MODULE*)calloc(moduleCount ? moduleCount : 1, sizeof(DUMP_MODULE));
+    if (!reader->snapshot || !reader->threads || !reader->ranges || !reader->modules) {
+        close_dump(reader);
+        return NULL;
+    }
+
+    if (stackSize) memcpy(reader->snapshot, stack, stackSize);
+    memcpy(reader->snapshot + stackSize, ctx, sizeof(CONTEXT));
+    reader->stats.dumpSize = stackSize + sizeof(CONTEXT);
+
+    reader->threads[0].Stack.StartOfMemoryRange = stackBase;
+    reader->threads[0].Stack.Memory.DataSize = stackSize;
+    reader->threads[0].ThreadContext.DataSize = sizeof(CONTEXT);
+    reader->threads[0].ThreadContext.Rva = stackSize;
+    reader->threadCount = 1;
+
+    reader->ranges[0].start = stackBase;
+    reader->ranges[0].size = stackSize;
+    reader->rangeCount = 1;
+
+    for (DWORD i = 0; i < moduleCount; i++) {
+        if (!modules[i].path || !modules[i].size) continue;
+
+        DUMP_MODULE* module = &reader->modules[reader->moduleCount];
+        module->path = _strdup(modules[i].path);
+        if (!module->path) {
+            close_dump(reader);
+            return NULL;
+        }
+        module->base = modules[i].base;
+        module->size = modules[i].size;
+        module->timeDateStamp = modules[i].timeDateStamp;
+        module->checkSum = modules[i].checkSum;
+        module->identity = module_identity(module_name_hash(module->path), modules[i].timeDateStamp,
+                                           modules[i].size, modules[i].checkSum);
+        reader->moduleCount++;
+    }
+
+    return reader;
+}
+
+UNWINDER_API BOOL convert_dump_to_seekable(const char* dumpPath, const char* outPath, DWORD blockSize) {
+    if (!dumpPath || !outPath) return FALSE;
+    if (blockSize == 0) blockSize = SEEKDUMP_DEFAULT_BLOCK_SIZE;
+    if (blockSize > SEEKDUMP_MAX_BLOCK_SIZE) {
+        set_error(16, "Block size too large", blockSize);
+        return FALSE;
+    }
+
+    BOOL ok = FALSE;
+    HANDLE in = CreateFileA(dumpPath, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    HANDLE out = INVALID_HANDLE_VALUE;
+    COMPRESSOR_HANDLE compressor = NULL;
+    SEEKDUMP_INDEX_ENTRY* index = NULL;
+    BYTE* raw = (BYTE*)malloc(blockSize);
+    BYTE* packed = (BYTE*)malloc(blockSize);
+
+    SEEKDUMP_HEADER header = {0};
+    LARGE_INTEGER fileSize = {0};
+    DWORD signature = 0;
+
+    if (in == INVALID_HANDLE_VALUE || !raw || !packed ||
+        !GetFileSizeEx(in, &fileSize) ||
+        !read_file_at(in, 0, &signature, sizeof(signature)) || signature != MINIDUMP_SIGNATURE) {
+        set_error(16, "Failed to open minidump for conversion", GetLastError());
+        goto cleanup;
+    }
+
+    header.Signature = SEEKDUMP_SIGNATURE;
+    header.Version = SEEKDUMP_VERSION;
+    header.Algorithm = SEEKDUMP_ALGORITHM;
+    header.BlockSize = blockSize;
+    header.UncompressedSize = (DWORD64)fileSize.QuadPart;
+
+    if (!seekdump_block_count(header.UncompressedSize, blockSize, &header.BlockCount)) {
+        set_error(16, "Dump too large for block size", blockSize);
+        goto cleanup;
+    }
+
+    index = (SEEKDUMP_INDEX_ENTRY*)calloc(header.BlockCount ? header.BlockCount : 1,
+                                          sizeof(SEEKDUMP_INDEX_ENTRY));
+    if (!index || !CreateCompressor(SEEKDUMP_ALGORITHM, NULL, &compressor)) {
+        set_error(16, "Failed to start seekable dump", GetLastError());
+        goto cleanup;
+    }
+
+    /* Only a validated input may replace the output file. */
+    out = CreateFileA(outPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+    if (out == INVALID_HANDLE_VALUE || !write_file_all(out, &header, sizeof(header))) {
+        set_error(16, "Failed to start seekable dump", GetLastError());
+        goto cleanup;
+    }
+
+    DWORD64 offset = sizeof(header);
+    for (DWORD i = 0; i < header.BlockCount; i++) {
+        DWORD64 remaining = header.UncompressedSize - (DWORD64)i * blockSize;
+        DWORD length = remaining < blockSize ? (DWORD)remaining : blockSize;
+        if (!read_file_at(in, (DWORD64)i * blockSize, raw, length)) {
+            set_error(16, "Failed to read minidump block", i);
+            goto cleanup;
+        }
+
+        /* Blocks that do not shrink are stored as-is. */
+        SIZE_T packedSize = 0;
+        BYTE* data = packed;
+        if (!Compress(compressor, raw, length, packed, length, &packedSize) || packedSize >= length) {
+            data = raw;
+            packedSize = length;
+            index[i].Flags = SEEKDUMP_BLOCK_STORED;
+        }
+
+        if (!write_file_all(out, data, (DWORD)packedSize)) {
+            set_error(16, "Failed to write seekable dump block", i);
+            goto cleanup;
+        }
+        index[i].Offset = offset;
+        index[i].CompressedSize = (DWORD)packedSize;
+        offset += packedSize;
+    }
+
+    header.IndexOffset = offset;
+    LARGE_INTEGER start = {0};
+    if (!write_file_all(out, index, header.BlockCount * sizeof(SEEKDUMP_INDEX_ENTRY)) ||
+        !SetFilePointerEx(out, start, NULL, FILE_BEGIN) ||
+        !write_file_all(out, &header, sizeof(header))) {
+        set_error(16, "Failed to write seekable dump index", GetLastError());
+        goto cleanup;
+    }
+
+    debug_print(UW_DEBUG_INFO, "Converted %llu bytes into %lu blocks (%llu bytes)\n",
+                header.UncompressedSize, header.BlockCount, offset + header.BlockCount * sizeof(SEEKDUMP_INDEX_ENTRY));
+    ok = TRUE;
+
+cleanup:
+    if (compressor) CloseCompressor(compressor);
+    if (in != INVALID_HANDLE_VALUE) CloseHandle(in);
+    if (out != INVALID_HANDLE_VALUE) {
+        CloseHandle(out);
+        /* A partial container still carries the signature; don't leave it behind. */
+        if (!ok) DeleteFileA(outPath);
+    }
+    free(index);
+    free(raw);
+    free(packed);
+    return ok;
+}
+
+UNWINDER_API BOOL expand_seekable_dump(const char* inPath, const char* dumpPath) {
+    if (!inPath || !dumpPath) return FALSE;
+
+    DUMP_READER* reader = open_dump(inPath, 1);
+    if (!reader) return FALSE;
+    if (!reader->seekable) {
+        set_error(17, "Dump is not a seekable container", 0);
+        close_dump(reader);
+        return FALSE;
+    }
+
+    HANDLE out = CreateFileA(dumpPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+    if (out == INVALID_HANDLE_VALUE) {
+        set_error(17, "Failed to create expanded dump", GetLastError());
+        close_dump(reader);
+        return FALSE;
+    }
+
+    BOOL ok = TRUE;
+    for (DWORD i = 0; ok && i < reader->header.BlockCount; i++) {
+        BYTE* data = load_block(reader, i);
+        ok = data && write_file_all(out, data, seekdump_block_length(reader, i));
+    }
+    CloseHandle(out);
+    if (!ok) {
+        set_error(17, "Failed to expand seekable dump", 0);
+        DeleteFileA(dumpPath);
+    }
+
+    close_dump(reader);
+    return ok;
+}
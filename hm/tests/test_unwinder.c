@@ -1,13 +1,58 @@
 #include <windows.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <winnt.h>
 #include <xmmintrin.h> 
+#include <dbghelp.h>
 
 typedef BOOL (__stdcall *TestAndUnwindFunc)();
 typedef BOOL (__stdcall *TestLeafFunc)();
 typedef BOOL (__stdcall *TestPushFunc)();
 
+typedef struct _DUMP_READER_STATS {
+    DWORD64 dumpSize;
+    DWORD64 bytesRead;
+    DWORD64 bytesDecompressed;
+    DWORD blocksDecompressed;
+    DWORD cacheHits;
+    DWORD cacheMisses;
+} DUMP_READER_STATS;
+
+typedef struct _MODULE_CACHE_STATS {
+    DWORD64 hits;
+    DWORD64 misses;
+    DWORD64 evictions;
+    DWORD64 rejected;
+    SIZE_T bytesUsed;
+    SIZE_T budget;
+    DWORD entries;
+} MODULE_CACHE_STATS;
+
+typedef struct _SNAPSHOT_MODULE {
+    DWORD64 base;
+    DWORD size;
+    DWORD timeDateStamp;
+    DWORD checkSum;
+    const char* path;
+} SNAPSHOT_MODULE;
+
+typedef BOOL (WINAPI *MiniDumpWriteDumpFunc)(HANDLE, DWORD, HANDLE, MINIDUMP_TYPE,
+                                             PVOID, PVOID, PVOID);
+typedef BOOL (__stdcall *ConvertDumpFunc)(const char*, const char*, DWORD);
+typedef BOOL (__stdcall *ExpandDumpFunc)(const char*, const char*);
+typedef void* (__stdcall *OpenDumpFunc)(const char*, DWORD);
+typedef void (__stdcall *CloseDumpFunc)(void*);
+typedef DWORD (__stdcall *GetDumpThreadCountFunc)(void*);
+typedef BOOL (__stdcall *WalkDumpThreadFunc)(void*, DWORD, DWORD64*, DWORD, DWORD*);
+typedef BOOL (__stdcall *GetDumpStatsFunc)(void*, DUMP_READER_STATS*);
+typedef void* (__stdcall *OpenStackSnapshotFunc)(const CONTEXT*, DWORD64, const BYTE*, DWORD,
+                                                 const SNAPSHOT_MODULE*, DWORD);
+typedef void* (__stdcall *CreateModuleCacheFunc)(SIZE_T);
+typedef void (__stdcall *DestroyModuleCacheFunc)(void*);
+typedef BOOL (__stdcall *GetModuleCacheStatsFunc)(void*, MODULE_CACHE_STATS*);
+typedef BOOL (__stdcall *AttachModuleCacheFunc)(void*, void*);
+
 void __declspec(noinline) deep_function_3() {
     printf("Entering deep_function_3\n");
     TestAndUnwindFunc test_func;
@@ -115,6 +160,406 @@ void __declspec(noinline) test_unwind_ops() {
     FreeLibrary(dll);
 }
 
+static double elapsed_ms(LARGE_INTEGER start) {
+    LARGE_INTEGER now, freq;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&freq);
+    return (double)(now.QuadPart - start.QuadPart) * 1000.0 / (double)freq.QuadPart;
+}
+
+static DWORD walk_all_threads(HMODULE dll, const char* path, void* cache, DUMP_READER_STATS* stats) {
+    OpenDumpFunc open_dump = (OpenDumpFunc)GetProcAddress(dll, "open_dump");
+    CloseDumpFunc close_dump = (CloseDumpFunc)GetProcAddress(dll, "close_dump");
+    GetDumpThreadCountFunc thread_count = (GetDumpThreadCountFunc)GetProcAddress(dll, "get_dump_thread_count");
+    WalkDumpThreadFunc walk_thread = (WalkDumpThreadFunc)GetProcAddress(dll, "walk_dump_thread");
+    GetDumpStatsFunc get_stats = (GetDumpStatsFunc)GetProcAddress(dll, "get_dump_stats");
+    AttachModuleCacheFunc attach_cache = (AttachModuleCacheFunc)GetProcAddress(dll, "attach_module_cache");
+
+    void* reader = open_dump(path, 0);
+    if (!reader) {
+        printf("  Failed to open %s\n", path);
+        return 0;
+    }
+    if (cache) attach_cache(reader, cache);
+
+    DWORD64 frames[64];
+    DWORD totalFrames = 0;
+    DWORD threads = thread_count(reader);
+    for (DWORD i = 0; i < threads; i++) {
+        DWORD count = 0;
+        if (walk_thread(reader, i, frames, 64, &count)) {
+            totalFrames += count;
+        }
+    }
+
+    get_stats(reader, stats);
+    close_dump(reader);
+    return totalFrames;
+}
+
+/* Walks every thread of both dumps side by side; returns the number of frames that differ. */
+static DWORD compare_dump_walks(HMODULE dll, const char* first, const char* second, DWORD* compared) {
+    OpenDumpFunc open_dump = (OpenDumpFunc)GetProcAddress(dll, "open_dump");
+    CloseDumpFunc close_dump = (CloseDumpFunc)GetProcAddress(dll, "close_dump");
+    GetDumpThreadCountFunc thread_count = (GetDumpThreadCountFunc)GetProcAddress(dll, "get_dump_thread_count");
+    WalkDumpThreadFunc walk_thread = (WalkDumpThreadFunc)GetProcAddress(dll, "walk_dump_thread");
+
+    *compared = 0;
+    void* a = open_dump(first, 0);
+    void* b = open_dump(second, 0);
+    DWORD mismatches = !a || !b || thread_count(a) != thread_count(b);
+
+    for (DWORD i = 0; !mismatches && i < thread_count(a); i++) {
+        DWORD64 framesA[64], framesB[64];
+        DWORD countA = 0, countB = 0;
+        walk_thread(a, i, framesA, 64, &countA);
+        walk_thread(b, i, framesB, 64, &countB);
+        if (countA != countB) mismatches++;
+
+        for (DWORD j = 0; j < countA && j < countB; j++) {
+            (*compared)++;
+            if (framesA[j] != framesB[j]) {
+                printf("  Thread %lu frame %lu: 0x%llx vs 0x%llx\n", i, j, framesA[j], framesB[j]);
+                mismatches++;
+            }
+        }
+    }
+
+    if (a) close_dump(a);
+    if (b) close_dump(b);
+    return mismatches;
+}
+
+static BOOL files_identical(const char* first, const char* second) {
+    HANDLE a = CreateFileA(first, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    HANDLE b = CreateFileA(second, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    BYTE* bufA = (BYTE*)malloc(1024 * 1024);
+    BYTE* bufB = (BYTE*)malloc(1024 * 1024);
+    BOOL same = a != INVALID_HANDLE_VALUE && b != INVALID_HANDLE_VALUE && bufA && bufB;
+
+    while (same) {
+        DWORD readA = 0, readB = 0;
+        if (!ReadFile(a, bufA, 1024 * 1024, &readA, NULL) || !ReadFile(b, bufB, 1024 * 1024, &readB, NULL)) {
+            same = FALSE;
+            break;
+        }
+        same = readA == readB && memcmp(bufA, bufB, readA) == 0;
+        if (readA == 0) break;
+    }
+
+    if (a != INVALID_HANDLE_VALUE) CloseHandle(a);
+    if (b != INVALID_HANDLE_VALUE) CloseHandle(b);
+    free(bufA);
+    free(bufB);
+    return same;
+}
+
+static BOOL write_self_dump(HMODULE dbghelp, const char* path) {
+    MiniDumpWriteDumpFunc write_dump = (MiniDumpWriteDumpFunc)GetProcAddress(dbghelp, "MiniDumpWriteDump");
+    if (!write_dump) return FALSE;
+
+    HANDLE file = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+    BOOL ok = file != INVALID_HANDLE_VALUE &&
+              write_dump(GetCurrentProcess(), GetCurrentProcessId(), file,
+                         MiniDumpWithFullMemory, NULL, NULL, NULL);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    return ok;
+}
+
+void __declspec(noinline) test_compressed_dump() {
+    printf("\nTesting seekable compressed dump...\n");
+    HMODULE dll = LoadLibraryA(".\\unwinder.dll");  
+    HMODULE dbghelp = LoadLibraryA("dbghelp.dll");
+    if (!dll || !dbghelp) {
+        printf("Failed to load unwinder.dll or dbghelp.dll\n");
+        return;
+    }
+
+    ConvertDumpFunc convert = (ConvertDumpFunc)GetProcAddress(dll, "convert_dump_to_seekable");
+    ExpandDumpFunc expand = (ExpandDumpFunc)GetProcAddress(dll, "expand_seekable_dump");
+    if (!convert || !expand || !GetProcAddress(dll, "walk_dump_thread")) {
+        printf("Failed to get dump functions\n");
+        FreeLibrary(dbghelp);
+        FreeLibrary(dll);
+        return;
+    }
+
+    BOOL ok = write_self_dump(dbghelp, ".\\test_full.dmp");
+    if (!ok || !convert(".\\test_full.dmp", ".\\test_full.sdmp", 0)) {
+        printf("Failed to write or convert dump\n");
+        FreeLibrary(dbghelp);
+        FreeLibrary(dll);
+        return;
+    }
+
+    DUMP_READER_STATS seekStats = {0}, plainStats = {0};
+    LARGE_INTEGER start;
+
+    QueryPerformanceCounter(&start);
+    DWORD seekFrames = walk_all_threads(dll, ".\\test_full.sdmp", NULL, &seekStats);
+    double seekMs = elapsed_ms(start);
+
+    QueryPerformanceCounter(&start);
+    ok = expand(".\\test_full.sdmp", ".\\test_expanded.dmp");
+    DWORD plainFrames = ok ? walk_all_threads(dll, ".\\test_expanded.dmp", NULL, &plainStats) : 0;
+    double plainMs = elapsed_ms(start);
+
+    printf("  Seekable: %lu frames, %llu of %llu bytes decompressed (%lu blocks, %lu hits, %lu misses), %.1f ms\n",
+           seekFrames, seekStats.bytesDecompressed, seekStats.dumpSize,
+           seekStats.blocksDecompressed, seekStats.cacheHits, seekStats.cacheMisses, seekMs);
+    printf("  Decompress-then-read: %lu frames, %llu bytes decompressed, %.1f ms\n",
+           plainFrames, plainStats.dumpSize, plainMs);
+
+    /* The container must round-trip exactly, walk the same frames, and not decompress everything. */
+    BOOL identical = ok && files_identical(".\\test_full.dmp", ".\\test_expanded.dmp");
+    DWORD compared = 0;
+    DWORD mismatches = compare_dump_walks(dll, ".\\test_full.sdmp", ".\\test_full.dmp", &compared);
+    printf("  Round trip %s, %lu frames compared, %lu mismatches\n",
+           identical ? "identical" : "differs", compared, mismatches);
+    printf("Seekable dump walk %s\n",
+           seekFrames > 0 && seekFrames == plainFrames && identical && compared > 0 && mismatches == 0 &&
+           seekStats.bytesDecompressed < seekStats.dumpSize ? "succeeded!" : "failed!");
+
+    DeleteFileA(".\\test_full.dmp");
+    DeleteFileA(".\\test_full.sdmp");
+    DeleteFileA(".\\test_expanded.dmp");
+    FreeLibrary(dbghelp);
+    FreeLibrary(dll);
+}
+
+#define SNAPSHOT_MAX_FRAMES 64
+#define SNAPSHOT_MAX_MODULES 16
+
+static DWORD snapshot_modules(PVOID* trace, USHORT traceCount, SNAPSHOT_MODULE* modules,
+                              char paths[][MAX_PATH]) {
+    DWORD count = 0;
+    for (USHORT i = 0; i < traceCount && count < SNAPSHOT_MAX_MODULES; i++) {
+        HMODULE handle = NULL;
+        if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+                                GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                                (LPCSTR)trace[i], &handle)) {
+            continue;
+        }
+
+        DWORD j = 0;
+        while (j < count && modules[j].base != (DWORD64)handle) j++;
+        if (j < count || !GetModuleFileNameA(handle, paths[count], MAX_PATH)) continue;
+
+        IMAGE_DOS_HEADER* dos = (IMAGE_DOS_HEADER*)handle;
+        IMAGE_NT_HEADERS64* nt = (IMAGE_NT_HEADERS64*)((BYTE*)handle + dos->e_lfanew);
+        modules[count].base = (DWORD64)handle;
+        modules[count].size = nt->OptionalHeader.SizeOfImage;
+        modules[count].timeDateStamp = nt->FileHeader.TimeDateStamp;
+        modules[count].checkSum = nt->OptionalHeader.CheckSum;
+        modules[count].path = paths[count];
+        count++;
+    }
+    return count;
+}
+
+/*
+ * Builds a context stopped on a "ret" of the function that owns body->Rip,
+ * with the return address on top of the stack. RtlVirtualUnwind, which
+ * emulates epilogs, is the reference: a candidate is only used if it
+ * unwinds it to the same caller as the body context.
+ */
+static BOOL epilog_context(const CONTEXT* body, CONTEXT* out, DWORD64* callerRip) {
+    DWORD64 imageBase = 0;
+    PRUNTIME_FUNCTION function = RtlLookupFunctionEntry(body->Rip, &imageBase, NULL);
+    if (!function) return FALSE;
+
+    CONTEXT caller = *body;
+    PVOID handlerData = NULL;
+    DWORD64 establisher = 0;
+    RtlVirtualUnwind(UNW_FLAG_NHANDLER, imageBase, body->Rip, function, &caller,
+                     &handlerData, &establisher, NULL);
+
+    for (DWORD rva = function->BeginAddress; rva < function->EndAddress; rva++) {
+        if (*(BYTE*)(imageBase + rva) != 0xC3) continue;
+
+        CONTEXT candidate = caller;
+        candidate.Rip = imageBase + rva;
+        candidate.Rsp = caller.Rsp - 8;
+
+        CONTEXT check = candidate;
+        PRUNTIME_FUNCTION owner = RtlLookupFunctionEntry(candidate.Rip, &imageBase, NULL);
+        if (!owner) continue;
+        RtlVirtualUnwind(UNW_FLAG_NHANDLER, imageBase, candidate.Rip, owner, &check,
+                         &handlerData, &establisher, NULL);
+        if (check.Rip == caller.Rip && check.Rsp == caller.Rsp) {
+            *out = candidate;
+            *callerRip = caller.Rip;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/*
+ * Captures this thread's registers and stack, walks the copy through
+ * open_stack_snapshot and compares the result with the system's own
+ * backtrace. Frame 0 differs (two call sites), every caller must match.
+ * The same stack is then walked from the function's own epilog.
+ */
+void __declspec(noinline) test_stack_snapshot() {
+    printf("\nTesting stack snapshot walk...\n");
+    HMODULE dll = LoadLibraryA(".\\unwinder.dll");
+    if (!dll) {
+        printf("Failed to load unwinder.dll: %lu\n", GetLastError());
+        return;
+    }
+
+    OpenStackSnapshotFunc open_snapshot = (OpenStackSnapshotFunc)GetProcAddress(dll, "open_stack_snapshot");
+    CloseDumpFunc close_dump = (CloseDumpFunc)GetProcAddress(dll, "close_dump");
+    WalkDumpThreadFunc walk_thread = (WalkDumpThreadFunc)GetProcAddress(dll, "walk_dump_thread");
+    CreateModuleCacheFunc create_cache = (CreateModuleCacheFunc)GetProcAddress(dll, "create_module_cache");
+    DestroyModuleCacheFunc destroy_cache = (DestroyModuleCacheFunc)GetProcAddress(dll, "destroy_module_cache");
+    GetModuleCacheStatsFunc cache_stats = (GetModuleCacheStatsFunc)GetProcAddress(dll, "get_module_cache_stats");
+    AttachModuleCacheFunc attach_cache = (AttachModuleCacheFunc)GetProcAddress(dll, "attach_module_cache");
+    if (!open_snapshot || !close_dump || !walk_thread || !create_cache ||
+        !destroy_cache || !cache_stats || !attach_cache) {
+        printf("Failed to get snapshot functions\n");
+        FreeLibrary(dll);
+        return;
+    }
+
+    CONTEXT ctx = {0};
+    RtlCaptureContext(&ctx);
+    PVOID trace[SNAPSHOT_MAX_FRAMES];
+    USHORT traceCount = RtlCaptureStackBackTrace(0, SNAPSHOT_MAX_FRAMES, trace, NULL);
+
+    ULONG_PTR stackLow = 0, stackHigh = 0;
+    GetCurrentThreadStackLimits(&stackLow, &stackHigh);
+    DWORD stackSize = (DWORD)(stackHigh - ctx.Rsp);
+    BYTE* stack = (BYTE*)malloc(stackSize);
+    if (!stack) {
+        FreeLibrary(dll);
+        return;
+    }
+    memcpy(stack, (const void*)ctx.Rsp, stackSize);
+
+    SNAPSHOT_MODULE modules[SNAPSHOT_MAX_MODULES];
+    static char paths[SNAPSHOT_MAX_MODULES][MAX_PATH];
+    DWORD moduleCount = snapshot_modules(trace, traceCount, modules, paths);
+
+    /* Small enough that the larger .pdata tables are refused and walked in place. */
+    void* cache = create_cache(256 * 1024);
+    DWORD64 frames[SNAPSHOT_MAX_FRAMES];
+    DWORD frameCount = 0;
+    DWORD compared = 0, mismatches = 0;
+
+    for (int pass = 0; pass < 2 && cache; pass++) {
+        void* reader = open_snapshot(&ctx, ctx.Rsp, stack, stackSize, modules, moduleCount);
+        if (!reader) break;
+        attach_cache(reader, cache);
+        walk_thread(reader, 0, frames, SNAPSHOT_MAX_FRAMES, &frameCount);
+        close_dump(reader);
+    }
+
+    for (DWORD i = 1; i < frameCount && i < traceCount; i++) {
+        compared++;
+        if (frames[i] != (DWORD64)trace[i]) {
+            printf("  Frame %lu: walked 0x%llx, expected 0x%p\n", i, frames[i], trace[i]);
+            mismatches++;
+        }
+    }
+
+    MODULE_CACHE_STATS stats = {0};
+    if (cache) cache_stats(cache, &stats);
+    printf("  %lu modules, %lu frames walked, %hu captured; cache: %llu hits, %llu misses\n",
+           moduleCount, frameCount, traceCount, stats.hits, stats.misses);
+    printf("Stack snapshot walk %s\n",
+           compared >= 2 && mismatches == 0 && stats.hits > 0 ? "succeeded!" : "failed!");
+
+    /* Unwinding the epilog context with the prolog's codes would skip past the caller. */
+    CONTEXT epilog = {0};
+    DWORD64 callerRip = 0;
+    DWORD epilogFrames = 0;
+    BOOL epilogFound = epilog_context(&ctx, &epilog, &callerRip);
+    if (epilogFound && cache) {
+        void* reader = open_snapshot(&epilog, ctx.Rsp, stack, stackSize, modules, moduleCount);
+        if (reader) {
+            attach_cache(reader, cache);
+            walk_thread(reader, 0, frames, SNAPSHOT_MAX_FRAMES, &epilogFrames);
+            close_dump(reader);
+        }
+    }
+
+    DWORD epilogMismatches = 0;
+    for (DWORD i = 1; i < epilogFrames && i < traceCount; i++) {
+        if (frames[i] != (DWORD64)trace[i]) epilogMismatches++;
+    }
+    printf("  Epilog at 0x%llx: %lu frames walked, frame 1 0x%llx, expected 0x%llx\n",
+           epilog.Rip, epilogFrames, epilogFrames > 1 ? frames[1] : 0, callerRip);
+    printf("Epilog snapshot walk %s\n",
+           epilogFound && epilogFrames > 1 && frames[1] == callerRip && epilogMismatches == 0 ?
+           "succeeded!" : "failed!");
+
+    if (cache) destroy_cache(cache);
+    free(stack);
+    FreeLibrary(dll);
+}
+
+/*
+ * Walks a self-dump with a cache too small for the working set: pages must
+ * be evicted, whole .pdata tables refused, and the frames must not change.
+ */
+void __declspec(noinline) test_module_cache_budget() {
+    printf("\nTesting module cache budget...\n");
+    HMODULE dll = LoadLibraryA(".\\unwinder.dll");
+    HMODULE dbghelp = LoadLibraryA("dbghelp.dll");
+    if (!dll || !dbghelp) {
+        printf("Failed to load unwinder.dll or dbghelp.dll\n");
+        return;
+    }
+
+    CreateModuleCacheFunc create_cache = (CreateModuleCacheFunc)GetProcAddress(dll, "create_module_cache");
+    DestroyModuleCacheFunc destroy_cache = (DestroyModuleCacheFunc)GetProcAddress(dll, "destroy_module_cache");
+    GetModuleCacheStatsFunc cache_stats = (GetModuleCacheStatsFunc)GetProcAddress(dll, "get_module_cache_stats");
+    if (!create_cache || !destroy_cache || !cache_stats || !write_self_dump(dbghelp, ".\\test_cache.dmp")) {
+        printf("Failed to get cache functions or write dump\n");
+        FreeLibrary(dbghelp);
+        FreeLibrary(dll);
+        return;
+    }
+
+    DUMP_READER_STATS readerStats = {0};
+    DWORD plainFrames = walk_all_threads(dll, ".\\test_cache.dmp", NULL, &readerStats);
+
+    MODULE_CACHE_STATS tiny = {0}, large = {0};
+    void* cache = create_cache(64 * 1024);
+    DWORD tinyFrames = cache ? walk_all_threads(dll, ".\\test_cache.dmp", cache, &readerStats) : 0;
+    if (cache) {
+        cache_stats(cache, &tiny);
+        destroy_cache(cache);
+    }
+
+    cache = create_cache(64 * 1024 * 1024);
+    DWORD largeFrames = 0;
+    DWORD64 firstHits = 0;
+    if (cache) {
+        largeFrames = walk_all_threads(dll, ".\\test_cache.dmp", cache, &readerStats);
+        cache_stats(cache, &large);
+        firstHits = large.hits;
+        walk_all_threads(dll, ".\\test_cache.dmp", cache, &readerStats);
+        cache_stats(cache, &large);
+        destroy_cache(cache);
+    }
+
+    printf("  64 KB: %lu frames, %llu evictions, %llu rejected, %llu of %llu bytes used\n",
+           tinyFrames, tiny.evictions, tiny.rejected, (DWORD64)tiny.bytesUsed, (DWORD64)tiny.budget);
+    printf("  64 MB: %lu frames, %llu hits on first walk, %llu after second, %llu rejected\n",
+           largeFrames, firstHits, large.hits, large.rejected);
+    printf("Module cache budget %s\n",
+           plainFrames > 0 && tinyFrames == plainFrames && largeFrames == plainFrames &&
+           tiny.evictions > 0 && tiny.rejected > 0 && tiny.bytesUsed <= tiny.budget &&
+           large.hits > firstHits ? "succeeded!" : "failed!");
+
+    DeleteFileA(".\\test_cache.dmp");
+    FreeLibrary(dbghelp);
+    FreeLibrary(dll);
+}
+
 int main() {
     printf("Starting unwinder tests...\n\n");
     
@@ -124,6 +569,9 @@ int main() {
     test_leaf_handling();
     test_xmm_function();  
     test_unwind_ops();    
+    test_compressed_dump();
+    test_stack_snapshot();
+    test_module_cache_budget();
     
     printf("\nAll tests completed.\n");
     return 0;
@@ -0,0 +1,349 @@
+#include <winsock2.h>
+#include <afunix.h>
+#include <windows.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UWS_REQUEST_MAGIC 0x51535755
+#define UWS_RESPONSE_MAGIC 0x52535755
+#define UWS_VERSION 3
+#define UWS_REQ_DUMP 1
+#define UWS_REQ_STATS 3
+#define MAX_CLIENTS 64
+
+#pragma pack(push, 1)
+typedef struct _UWS_REQUEST_HEADER {
+    DWORD magic;
+    WORD version;
+    WORD type;
+    DWORD requestId;
+    DWORD payloadSize;
+} UWS_REQUEST_HEADER;
+
+typedef struct _UWS_DUMP_REQUEST {
+    DWORD threadIndex;
+    WORD maxFrames;
+    WORD pathLength;
+} UWS_DUMP_REQUEST;
+
+typedef struct _UWS_RESPONSE_HEADER {
+    DWORD magic;
+    WORD status;
+    WORD frameCount;
+    DWORD requestId;
+    DWORD payloadSize;
+} UWS_RESPONSE_HEADER;
+
+typedef struct _UWS_STATS_RESPONSE {
+    DWORD64 requests;
+    DWORD64 cacheHits;
+    DWORD64 cacheMisses;
+    DWORD64 evictions;
+    DWORD64 rejected;
+    DWORD64 bytesUsed;
+    DWORD64 budget;
+    DWORD entries;
+} UWS_STATS_RESPONSE;
+#pragma pack(pop)
+
+typedef struct _MIX {
+    BYTE* data;
+    DWORD* offsets;
+    DWORD count;
+} MIX;
+
+typedef struct _CLIENT {
+    const char* socketPath;
+    const MIX* mix;
+    DWORD first;
+    DWORD rounds;
+    double* latencies;
+    DWORD completed;
+    DWORD failed;
+} CLIENT;
+
+static BOOL recv_all(SOCKET s, void* buffer, DWORD size) {
+    char* p = (char*)buffer;
+    while (size > 0) {
+        int n = recv(s, p, (int)size, 0);
+        if (n <= 0) return FALSE;
+        p += n;
+        size -= n;
+    }
+    return TRUE;
+}
+
+static BOOL send_all(SOCKET s, const void* buffer, DWORD size) {
+    const char* p = (const char*)buffer;
+    while (size > 0) {
+        int n = send(s, p, (int)size, 0);
+        if (n <= 0) return FALSE;
+        p += n;
+        size -= n;
+    }
+    return TRUE;
+}
+
+static SOCKET connect_service(const char* socketPath) {
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strcpy_s(addr.sun_path, sizeof(addr.sun_path), socketPath);
+
+    SOCKET s = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s != INVALID_SOCKET && connect(s, (struct sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR) {
+        closesocket(s);
+        s = INVALID_SOCKET;
+    }
+    return s;
+}
+
+/* Sends one request and waits for its response; the payload is discarded. */
+static BOOL round_trip(SOCKET s, const UWS_REQUEST_HEADER* header, const BYTE* payload,
+                       UWS_RESPONSE_HEADER* response, void* body, DWORD bodySize) {
+    if (!send_all(s, header, sizeof(*header)) ||
+        (header->payloadSize && !send_all(s, payload, header->payloadSize)) ||
+        !recv_all(s, response, sizeof(*response)) ||
+        response->magic != UWS_RESPONSE_MAGIC || response->requestId != header->requestId) {
+        return FALSE;
+    }
+
+    BYTE discard[4096];
+    DWORD remaining = response->payloadSize;
+    while (remaining > 0) {
+        DWORD chunk = remaining < sizeof(discard) ? remaining : sizeof(discard);
+        if (!recv_all(s, discard, chunk)) return FALSE;
+        if (body && bodySize >= chunk) {
+            memcpy(body, discard, chunk);
+            body = (BYTE*)body + chunk;
+            bodySize -= chunk;
+        }
+        remaining -= chunk;
+    }
+    return TRUE;
+}
+
+static BOOL query_stats(const char* socketPath, UWS_STATS_RESPONSE* stats) {
+    SOCKET s = connect_service(socketPath);
+    if (s == INVALID_SOCKET) return FALSE;
+
+    UWS_REQUEST_HEADER header = {UWS_REQUEST_MAGIC, UWS_VERSION, UWS_REQ_STATS, 0, 0};
+    UWS_RESPONSE_HEADER response;
+    memset(stats, 0, sizeof(*stats));
+    BOOL ok = round_trip(s, &header, NULL, &response, stats, sizeof(*stats));
+    closesocket(s);
+    return ok;
+}
+
+static BOOL load_mix(const char* path, MIX* mix) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
+    LARGE_INTEGER size = {0};
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size) || size.QuadPart > MAXDWORD) {
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        return FALSE;
+    }
+
+    DWORD bytesRead = 0;
+    mix->data = (BYTE*)malloc((size_t)size.QuadPart + 1);
+    BOOL ok = mix->data && ReadFile(file, mix->data, (DWORD)size.QuadPart, &bytesRead, NULL) &&
+              bytesRead == (DWORD)size.QuadPart;
+    CloseHandle(file);
+    if (!ok) return FALSE;
+
+    DWORD capacity = 0;
+    for (DWORD offset = 0; offset + sizeof(UWS_REQUEST_HEADER) <= bytesRead; ) {
+        UWS_REQUEST_HEADER* header = (UWS_REQUEST_HEADER*)(mix->data + offset);
+        if (header->magic != UWS_REQUEST_MAGIC ||
+            header->payloadSize > bytesRead - offset - sizeof(UWS_REQUEST_HEADER)) {
+            printf("Corrupt request at offset %lu in %s\n", offset, path);
+            return FALSE;
+        }
+
+        if (mix->count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            DWORD* grown = (DWORD*)realloc(mix->offsets, capacity * sizeof(DWORD));
+            if (!grown) return FALSE;
+            mix->offsets = grown;
+        }
+        mix->offsets[mix->count++] = offset;
+        offset += sizeof(UWS_REQUEST_HEADER) + header->payloadSize;
+    }
+    return mix->count > 0;
+}
+
+/* Builds a mix of dump requests for the first threads of one dump. */
+static BOOL build_dump_mix(const char* dumpPath, DWORD threads, MIX* mix) {
+    WORD pathLength = (WORD)strlen(dumpPath);
+    DWORD frameSize = sizeof(UWS_REQUEST_HEADER) + sizeof(UWS_DUMP_REQUEST) + pathLength;
+
+    mix->data = (BYTE*)malloc((size_t)frameSize * threads);
+    mix->offsets = (DWORD*)malloc(threads * sizeof(DWORD));
+    if (!mix->data || !mix->offsets) return FALSE;
+
+    for (DWORD i = 0; i < threads; i++) {
+        BYTE* frame = mix->data + (size_t)i * frameSize;
+        UWS_REQUEST_HEADER header = {UWS_REQUEST_MAGIC, UWS_VERSION, UWS_REQ_DUMP, 0,
+                                     sizeof(UWS_DUMP_REQUEST) + pathLength};
+        UWS_DUMP_REQUEST request = {i, 64, pathLength};
+        memcpy(frame, &header, sizeof(header));
+        memcpy(frame + sizeof(header), &request, sizeof(request));
+        memcpy(frame + sizeof(header) + sizeof(request), dumpPath, pathLength);
+        mix->offsets[i] = i * frameSize;
+    }
+    mix->count = threads;
+    return TRUE;
+}
+
+static DWORD WINAPI client_main(LPVOID param) {
+    CLIENT* client = (CLIENT*)param;
+    SOCKET s = connect_service(client->socketPath);
+    if (s == INVALID_SOCKET) {
+        client->failed = client->rounds * client->mix->count;
+        return 0;
+    }
+
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+
+    for (DWORD round = 0; round < client->rounds; round++) {
+        for (DWORD n = 0; n < client->mix->count; n++) {
+            DWORD index = (client->first + n) % client->mix->count;
+            BYTE* frame = client->mix->data + client->mix->offsets[index];
+            UWS_REQUEST_HEADER header;
+            memcpy(&header, frame, sizeof(header));
+            header.requestId = round * client->mix->count + n + 1;
+
+            LARGE_INTEGER start, end;
+            UWS_RESPONSE_HEADER response;
+            QueryPerformanceCounter(&start);
+            BOOL ok = round_trip(s, &header, frame + sizeof(header), &response, NULL, 0);
+            QueryPerformanceCounter(&end);
+
+            if (!ok) {
+                client->failed += client->rounds * client->mix->count - client->completed - client->failed;
+                closesocket(s);
+                return 0;
+            }
+            if (response.status != 0) client->failed++;
+            client->latencies[client->completed++] =
+                (double)(end.QuadPart - start.QuadPart) * 1000000.0 / (double)freq.QuadPart;
+        }
+    }
+
+    closesocket(s);
+    return 0;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double left = *(const double*)a, right = *(const double*)b;
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+static double percentile(const double* sorted, DWORD count, DWORD pct) {
+    DWORD index = (DWORD)(((DWORD64)count * pct) / 100);
+    return sorted[index < count ? index : count - 1];
+}
+
+static double cache_hit_rate(const UWS_STATS_RESPONSE* before, const UWS_STATS_RESPONSE* after) {
+    DWORD64 hits = after->cacheHits - before->cacheHits;
+    DWORD64 lookups = hits + after->cacheMisses - before->cacheMisses;
+    return lookups ? 100.0 * (double)hits / (double)lookups : 0.0;
+}
+
+int main(int argc, char** argv) {
+    const char* socketPath = "unwinder.sock";
+    const char* mixPath = NULL;
+    const char* dumpPath = NULL;
+    DWORD dumpThreads = 8;
+    DWORD clients = 8;
+    DWORD rounds = 20;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--socket") == 0) socketPath = argv[i + 1];
+        else if (strcmp(argv[i], "--mix") == 0) mixPath = argv[i + 1];
+        else if (strcmp(argv[i], "--dump") == 0) dumpPath = argv[i + 1];
+        else if (strcmp(argv[i], "--threads") == 0) dumpThreads = strtoul(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--clients") == 0) clients = strtoul(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--rounds") == 0) rounds = strtoul(argv[i + 1], NULL, 10);
+    }
+
+    if ((!mixPath && !dumpPath) || clients == 0 || clients > MAX_CLIENTS || rounds == 0 || dumpThreads == 0) {
+        printf("Usage: %s (--mix recorded.bin | --dump file.dmp [--threads n]) "
+               "[--socket path] [--clients n] [--rounds n]\n", argv[0]);
+        return 1;
+    }
+
+    MIX mix = {0};
+    if (mixPath ? !load_mix(mixPath, &mix) : !build_dump_mix(dumpPath, dumpThreads, &mix)) {
+        printf("Failed to load request mix\n");
+        return 1;
+    }
+
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        printf("WSAStartup failed\n");
+        return 1;
+    }
+
+    UWS_STATS_RESPONSE before, after;
+    if (!query_stats(socketPath, &before)) {
+        printf("Failed to reach unwind service at %s\n", socketPath);
+        return 1;
+    }
+
+    printf("Replaying %lu requests x %lu rounds on %lu clients...\n", mix.count, rounds, clients);
+
+    CLIENT state[MAX_CLIENTS] = {0};
+    HANDLE threads[MAX_CLIENTS];
+    LARGE_INTEGER start, end, freq;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+
+    for (DWORD i = 0; i < clients; i++) {
+        state[i].socketPath = socketPath;
+        state[i].mix = &mix;
+        state[i].first = (DWORD)(((DWORD64)i * mix.count) / clients);
+        state[i].rounds = rounds;
+        state[i].latencies = (double*)malloc((size_t)rounds * mix.count * sizeof(double));
+        threads[i] = CreateThread(NULL, 0, client_main, &state[i], 0, NULL);
+    }
+    WaitForMultipleObjects(clients, threads, TRUE, INFINITE);
+    QueryPerformanceCounter(&end);
+
+    DWORD total = 0, failed = 0;
+    for (DWORD i = 0; i < clients; i++) {
+        total += state[i].completed;
+        failed += state[i].failed;
+    }
+
+    double* latencies = (double*)malloc((total ? total : 1) * sizeof(double));
+    DWORD n = 0;
+    for (DWORD i = 0; i < clients; i++) {
+        memcpy(latencies + n, state[i].latencies, state[i].completed * sizeof(double));
+        n += state[i].completed;
+        CloseHandle(threads[i]);
+        free(state[i].latencies);
+    }
+
+    if (!query_stats(socketPath, &after)) {
+        printf("Failed to query service stats\n");
+        return 1;
+    }
+
+    double seconds = (double)(end.QuadPart - start.QuadPart) / (double)freq.QuadPart;
+    printf("  Completed: %lu (%lu failed) in %.2f s, %.0f req/s\n",
+           total, failed, seconds, seconds > 0 ? total / seconds : 0.0);
+    if (total) {
+        qsort(latencies, total, sizeof(double), compare_doubles);
+        printf("  Latency: p50=%.0f us  p99=%.0f us  max=%.0f us\n",
+               percentile(latencies, total, 50), percentile(latencies, total, 99), latencies[total - 1]);
+    }
+    printf("  Module cache: hit rate %.1f%%, %llu evictions, %llu/%llu bytes in %lu entries\n",
+           cache_hit_rate(&before, &after), after.evictions - before.evictions,
+           after.bytesUsed, after.budget, after.entries);
+
+    free(latencies);
+    WSACleanup();
+    return failed ? 1 : 0;
+}